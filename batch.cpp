@@ -0,0 +1,113 @@
+#include "batch.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+#include "console.h"
+#include "engine/job_runner.h"
+#include "engine/odds.h"
+
+namespace {
+
+struct BatchTotals {
+    std::mutex mutex;
+    uint64_t finished = 0;
+    uint64_t cancelled = 0;
+    uint64_t iterations = 0;
+    double job_seconds = 0.0;
+};
+
+void report_job(const JobStatus& status, BatchTotals& totals)
+{
+    bool sorted = status.state == JobState::Sorted;
+
+    {
+        std::lock_guard<std::mutex> lock(totals.mutex);
+        totals.finished += sorted;
+        totals.cancelled += !sorted;
+        totals.iterations += status.iterations;
+        totals.job_seconds += status.seconds;
+    }
+
+    std::lock_guard<std::mutex> lock(console_mutex());
+    std::cout << "Job " << status.id << ": " << status.input << " -> " << (sorted ? status.result : "cancelled")
+        << " after " << status.iterations << " iterations in " << status.seconds * 1000.0 << " ms, "
+        << 100.0 * success_percentile(compute_odds(status.input.c_str()), static_cast<double>(status.iterations)) << " percentile" << std::endl;
+}
+
+}
+
+int run_batch_mode(const std::string& path, int threads, const std::atomic<bool>& cancel)
+{
+    std::ifstream file;
+    if (path != "-") {
+        file.open(path);
+        if (!file) {
+            std::cout << "Failed to open batch file " << path << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = path == "-" ? std::cin : file;
+
+    BatchTotals totals;
+    uint64_t submitted = 0;
+    std::vector<WorkerPool::WorkerStats> workers;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    {
+        JobRunner runner(threads, cancel);
+
+        // Jobs are queued as lines arrive, so a long file or a pipe starts
+        // sorting before it has been read to the end.
+        std::string line;
+        while (!cancel.load() && std::getline(in, line)) {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos)
+                continue;
+            line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+
+            if (line.find_first_not_of("0123456789") != std::string::npos) {
+                std::lock_guard<std::mutex> lock(console_mutex());
+                std::cout << "Skipping line that is not a number: " << line << std::endl;
+                continue;
+            }
+
+            runner.submit(line, [&totals](const JobStatus& status) { report_job(status, totals); });
+            submitted++;
+        }
+
+        runner.wait_idle();
+        workers = runner.worker_stats();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    WorkerPool::WorkerStats sum = { 0, 0, 0, 0.0 };
+    for (const WorkerPool::WorkerStats& worker : workers) {
+        sum.tasks += worker.tasks;
+        sum.steals += worker.steals;
+        sum.failed_steals += worker.failed_steals;
+        sum.idle_seconds += worker.idle_seconds;
+    }
+
+    std::lock_guard<std::mutex> lock(console_mutex());
+    std::cout << std::endl << "=======================================" << std::endl;
+    std::cout << "Jobs: " << submitted << " on " << threads << " threads" << std::endl;
+    std::cout << "Sorted: " << totals.finished << ", cancelled: " << totals.cancelled << std::endl;
+    std::cout << "Total iterations: " << totals.iterations << std::endl;
+    std::cout << "Iterations per second: " << (seconds > 0.0 ? totals.iterations / seconds : 0.0) << std::endl;
+    std::cout << "Jobs per second: " << (seconds > 0.0 ? submitted / seconds : 0.0) << std::endl;
+    std::cout << "Average job time: " << (submitted ? totals.job_seconds / submitted * 1000.0 : 0.0) << " ms" << std::endl;
+    std::cout << "Tasks: " << sum.tasks << ", steals: " << sum.steals << ", failed steal scans: " << sum.failed_steals << std::endl;
+    std::cout << "Idle: " << (seconds > 0.0 ? 100.0 * sum.idle_seconds / (seconds * threads) : 0.0) << "% of worker time" << std::endl;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        std::cout << "  Worker " << i << ": " << workers[i].tasks << " tasks, " << workers[i].steals << " steals, idle "
+            << workers[i].idle_seconds * 1000.0 << " ms" << std::endl;
+    }
+    std::cout << "Total time: " << seconds << " s" << std::endl;
+    std::cout << "=======================================" << std::endl << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+// Reads one number per line from path ("-" reads stdin) and sorts each one
+// as a job on a pool of threads workers that lives for the whole batch.
+// Prints a line per finished job and a summary once the input runs out or
+// cancel is set. Returns non-zero if the input could not be opened.
+int run_batch_mode(const std::string& path, int threads, const std::atomic<bool>& cancel);
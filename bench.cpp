@@ -0,0 +1,76 @@
+#include "bench.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "engine/kernels.h"
+#include "engine/search_engine.h"
+
+namespace {
+
+const std::chrono::milliseconds POLL_INTERVAL(10);
+const size_t NUMBER_COLUMN = 24;
+
+// Long numbers keep their head and length so the table stays aligned.
+std::string column_label(const std::string& input)
+{
+    if (input.size() < NUMBER_COLUMN)
+        return input;
+    std::string length = "..(" + std::to_string(input.size()) + ")";
+    return input.substr(0, NUMBER_COLUMN - 1 - length.size()) + length;
+}
+
+}
+
+int run_bench(const std::vector<std::string>& inputs, const std::vector<Mode>& modes, int threads, double seconds,
+    bool seeded, uint64_t seed, const std::atomic<bool>& cancel)
+{
+    if (inputs.empty() || modes.empty()) {
+        std::cout << "--bench needs at least one number and one mode" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Benchmarking on " << threads << " threads, at most " << seconds << " s per run." << std::endl << std::endl;
+    std::cout << std::left << std::setw(NUMBER_COLUMN) << "number" << std::setw(10) << "mode" << std::right << std::setw(16) << "attempts"
+        << std::setw(16) << "attempts/s" << std::setw(12) << "seconds" << "  result" << std::endl;
+
+    for (const std::string& input : inputs) {
+        if (digits_sorted(input.c_str(), input.size())) {
+            std::cout << std::left << std::setw(NUMBER_COLUMN) << column_label(input) << "already sorted" << std::endl;
+            continue;
+        }
+
+        for (Mode mode : modes) {
+            if (cancel.load())
+                return 0;
+
+            SearchEngine engine(input);
+            engine.set_mode(mode);
+            if (seeded)
+                engine.set_seed(seed);
+            engine.start(threads);
+
+            SearchStats& stats = engine.search().stats;
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+            while (!stats.finished.load() && std::chrono::steady_clock::now() < deadline && !cancel.load()) {
+                std::this_thread::sleep_for(POLL_INTERVAL);
+            }
+            engine.stop();
+            engine.join();
+
+            double elapsed = std::chrono::duration<double>(stats.end_time - stats.start_time).count();
+            uint64_t attempts = stats.total_iterations.load();
+            std::cout << std::left << std::setw(NUMBER_COLUMN) << column_label(input) << std::setw(10) << MODE_NAMES[static_cast<int>(mode)] << std::right
+                << std::setw(16) << attempts << std::setw(16) << std::fixed << std::setprecision(0) << (elapsed > 0.0 ? attempts / elapsed : 0.0)
+                << std::setw(12) << std::setprecision(3) << elapsed << "  " << (stats.success.load() ? "sorted" : "timed out");
+            if (mode == Mode::Hybrid && stats.merge_phase_us.load() >= 0)
+                std::cout << " (bogo " << stats.bogo_phase_us.load() / 1000.0 << " ms, merge " << stats.merge_phase_us.load() / 1000.0 << " ms)";
+            std::cout << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/modes.h"
+
+// Runs every mode on every input, one search at a time with threads
+// workers, for at most seconds each, and prints a table of attempts,
+// throughput and time to the sorted number. seeded applies seed to the
+// modes that take one. Returns non-zero if there was nothing to run.
+int run_bench(const std::vector<std::string>& inputs, const std::vector<Mode>& modes, int threads, double seconds,
+    bool seeded, uint64_t seed, const std::atomic<bool>& cancel);
@@ -1,7 +1,6 @@
 #include <iostream>
 #include <chrono>
 #include <string>
-#include <mpir.h>
 #include <cstring>
 #include <algorithm>
 #include <vector>
@@ -9,111 +8,51 @@
 #include <atomic>
 #include <Windows.h>
 #include <mutex>
+#include <condition_variable>
+#include <cmath>
 
+#include "batch.h"
+#include "bench.h"
 #include "bogo.h"
+#include "console.h"
+#include "data_sort.h"
+#include "daemon.h"
+#include "options.h"
+#include "race.h"
+#include "engine/checkpoint.h"
+#include "engine/kernels.h"
+#include "engine/search_engine.h"
+#include "ui/terminal.h"
 #include "ui/ui.h"
 #ifdef USE_IMGUI
 #include "imgui/imgui.h"
 #endif
 
-std::atomic<bool> foundSorted(false);
+// Every search started by _main, so Ctrl+C can stop them all. Console
+// front end state only; the engine itself keeps no globals.
 std::mutex mtx;
-std::vector<int> threadIterations;
+std::vector<std::unique_ptr<SearchEngine>> engines;
+
+// Set by Ctrl+C to end --batch and --serve runs.
+std::atomic<bool> jobs_stopped(false);
 
 const int SCREEN_W = 1280;
 const int SCREEN_H = 720;
 
-
-bool is_sorted(const char* numStr) {
-    size_t length = std::strlen(numStr);
-
-    mpz_t num;
-    mpz_init(num);
-    mpz_set_str(num, numStr, 10);
-
-    bool ascending = true;
-    for (size_t i = 1; i < length; ++i) {
-        if (numStr[i] < numStr[i - 1]) {
-            ascending = false;
-            break;
-        }
-    }
-
-    bool descending = true;
-    for (size_t i = 1; i < length; ++i) {
-        if (numStr[i] > numStr[i - 1]) {
-            descending = false;
-            break;
-        }
-    }
-
-    bool sorted = ascending || descending;
-    mpz_clear(num);
-
-    return sorted;
-}
-
-void randomize_digits(char* numStr) {
-    size_t length = std::strlen(numStr);
-
-    mpz_t num;
-    mpz_init(num);
-    mpz_set_str(num, numStr, 10);
-
-    std::vector<char> digits;
-    for (size_t i = 0; i < length; ++i) {
-        digits.push_back(numStr[i]);
-    }
-
-    std::random_shuffle(digits.begin(), digits.end());
-
-    for (size_t i = 0; i < length; ++i) {
-        numStr[i] = digits[i];
+void stop_all_searches() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& engine : engines) {
+        engine->stop();
     }
-
-    mpz_clear(num);
-}
-
-void bogosort_thread(const char* input, int threadId, UI* ui) {
-    int count = 0;
-    char* num = _strdup(input);
-
-    while (!foundSorted.load()) {
-        randomize_digits(num);
-        ++count;
-
-#ifdef USE_IMGUI
-        //ImGui::DebugLog("Thread %d: %s\n", threadId, num); // this breaks D:
-#endif
-
-        ui->render_number(num);
-
-        ui->current_iteration = num;
-        ui->total_iterations++;
-
-        if (is_sorted(num)) {
-            foundSorted.store(true);
-            std::cout << "Thread " << threadId << " found the sorted number: " << num << " after " << count << " iterations." << std::endl;
-            ui->success = true;
-            ui->render_number(num);
-            ui->current_iteration = num;
-            ui->total_iterations++;
-        }
-    }
-
-    {
-        std::lock_guard<std::mutex> lock(mtx);
-        threadIterations[threadId] = count;
-    }
-
-    free(num);
 }
 
 BOOL WINAPI ConsoleHandlerRoutine(DWORD fdwCtrlType)
 {
     if (fdwCtrlType == CTRL_C_EVENT || fdwCtrlType == CTRL_BREAK_EVENT || fdwCtrlType == CTRL_CLOSE_EVENT) {
+        stop_all_searches();
+        jobs_stopped.store(true);
+        std::lock_guard<std::mutex> lock(console_mutex());
         std::cout << "Process terminated, loading data..." << std::endl;
-        foundSorted.store(true);
 		return true;
 	}
     else {
@@ -148,79 +87,244 @@ std::string format_duration(const std::chrono::steady_clock::time_point& start,
     return formattedInterval;
 }
 
-void logic_thread(int num_threads, const char* num, UI* ui) {
-    std::vector<std::thread> threads;
-    threadIterations.resize(num_threads, 0);
-
-    std::cout << std::endl << "Starting " << num_threads << " threads to find the sorted number." << std::endl << std::endl;
-
-    ui->render_number(num);
-    
-    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-
-    ui->start_time = begin;
-
-    for (int i = 0; i < num_threads; ++i) {
-        threads.emplace_back(bogosort_thread, num, i, ui);
-    }
-
-    for (auto& thread : threads) {
-        thread.join();
-    }
+std::string format_startup(const std::atomic<int64_t>& event) {
+    int64_t us = event.load();
+    return us < 0 ? "n/a" : std::to_string(us / 1000.0) + " ms";
+}
 
-    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+// Runs on the search's logic thread once its workers have exited.
+void report_search(Search& search) {
+    SearchStats& stats = search.stats;
+    std::chrono::steady_clock::time_point begin = stats.start_time;
+    std::chrono::steady_clock::time_point end = stats.end_time;
+    uint64_t totalIterations = stats.total_iterations.load();
+    int num_threads = search.control.active_threads.load();
 
-    int totalIterations = 0;
-    for (int i = 0; i < num_threads; ++i) {
-        totalIterations += threadIterations[i];
-    }
+    std::lock_guard<std::mutex> lock(console_mutex());
+    if (stats.winner.load() >= 0)
+        std::cout << "Thread " << stats.winner.load() << " found the sorted number: " << stats.read_snapshot() << " after " << stats.winner_iterations.load() << " iterations." << std::endl;
+    else if (search.mode == Mode::Hybrid && stats.success.load())
+        std::cout << "Merged the sorted number: " << stats.read_snapshot() << std::endl;
 
     std::cout << std::endl << "=======================================" << std::endl;
+    std::cout << "Number: " << search.input << std::endl;
+    std::cout << "Mode: " << MODE_NAMES[static_cast<int>(search.mode)] << std::endl;
+    std::cout << "Seed: " << search.seed << (search.deterministic ? " (deterministic)" : "") << std::endl;
+    if (search.control.kernel.load() == static_cast<int>(Kernel::Replayable) && stats.winner.load() >= 0)
+        std::cout << "Replay the winner with: --seed " << search.seed << " --replay-attempt " << stats.winner.load() << ":" << stats.winner_iterations.load() << std::endl;
     std::cout << "Total iterations for all threads: " << totalIterations << std::endl;
+    if (stats.shuffle_odds) {
+        std::cout << "Odds per attempt: " << stats.odds.ratio << ", expected attempts: " << stats.odds.expected_attempts << std::endl;
+        std::cout << "Percentile reached: " << 100.0 * success_percentile(stats.odds, static_cast<double>(totalIterations)) << "%" << std::endl;
+    }
+    else if (stats.enumeration_size > 0.0) {
+        std::cout << "Arrangements walked: " << totalIterations << " of " << stats.enumeration_size << " ("
+            << 100.0 * static_cast<double>(totalIterations) / stats.enumeration_size << "%)" << std::endl;
+    }
     std::cout << "Average iterations per thread: " << static_cast<double>(totalIterations) / static_cast<double>(num_threads) << std::endl;
     std::cout << "Average iterations per second: " << static_cast<double>(totalIterations) / std::chrono::duration_cast<std::chrono::seconds>(end - begin).count() << std::endl;
     std::cout << "Average iterations per second per thread: " << static_cast<double>(totalIterations) / static_cast<double>(num_threads) / std::chrono::duration_cast<std::chrono::seconds>(end - begin).count() << std::endl;
     std::cout << "Total time: " << format_duration(begin, end) << std::endl;
+    std::cout << "Time to first iteration: " << format_startup(stats.first_iteration_us) << std::endl;
+    std::cout << "Time to first frame: " << format_startup(stats.first_frame_us) << std::endl;
+    if (search.mode == Mode::Hybrid)
+        std::cout << "Phases: " << stats.hybrid_chunks << " chunks bogosorted in " << format_startup(stats.bogo_phase_us)
+            << ", merged in " << format_startup(stats.merge_phase_us) << std::endl;
+
+    uint32_t best_prefix = 0;
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        best_prefix = std::max(best_prefix, stats.threads[i].best_prefix.load());
+    }
+    if (stats.initial_inversions)
+        std::cout << "Inversions left: " << (stats.success.load() ? 0 : stats.inversions_left()) << " of " << stats.initial_inversions << std::endl;
+    std::cout << "Longest sorted prefix seen: " << best_prefix << " of " << search.input.size() << " digits" << std::endl;
+
+    if (stats.checkpoints.load() || stats.checkpoint_failures.load())
+        std::cout << "Checkpoints written: " << stats.checkpoints.load() << ", failed: " << stats.checkpoint_failures.load() << std::endl;
     std::cout << "=======================================" << std::endl << std::endl;
 }
 
 int __cdecl _main(int argc, char* argv[]) {
 
+    Options options;
+    if (!parse_options(argc, argv, options))
+        return 1;
+
     SetConsoleCtrlHandler(ConsoleHandlerRoutine, true);
 
-    std::string input;
-    std::cout << "Enter a number: ";
-    std::cin >> input;
+    // Rebuilds one attempt of a finished --replay run, e.g. to check the
+    // winner a summary reported.
+    if (options.replay_one) {
+        if (options.inputs.size() != 1 || !options.seeded || options.replay_thread < 0 || options.replay_attempt == 0) {
+            std::cout << "--replay-attempt needs one number, --seed and <thread>:<attempt> with attempt >= 1" << std::endl;
+            return 1;
+        }
+        const std::string& input = options.inputs.front();
+        std::string digits(input.size(), '0');
+        ReplayKey key = { input.c_str(), options.seed, static_cast<uint32_t>(options.replay_thread) };
+        replay_attempt(&digits[0], digits.size(), key, options.replay_attempt);
+        std::cout << digits << (digits_sorted(digits.c_str(), digits.size()) ? " (sorted)" : " (not sorted)") << std::endl;
+        return 0;
+    }
 
-    const char* num = input.c_str();
+    // Batch, daemon, benchmark, race and data modes never prompt: stdin may
+    // be the batch itself, a daemon has nobody to ask, and the rest should
+    // run unattended.
+    if (!options.batch_path.empty() || !options.socket_path.empty() || !options.bench_modes.empty() || !options.portfolio_modes.empty()
+        || !options.data_path.empty()) {
+        int num_threads = options.threads ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+        num_threads = std::max(1, std::min(num_threads, MAX_THREADS));
+        if (!options.bench_modes.empty())
+            return run_bench(options.inputs, options.bench_modes, num_threads, options.bench_seconds, options.seeded, options.seed, jobs_stopped);
+        if (!options.portfolio_modes.empty())
+            return run_race(options.inputs, options.portfolio_modes, num_threads, options.seeded, options.seed, jobs_stopped);
+        if (!options.data_path.empty())
+            return run_data_sort(options.data_path, options.element, num_threads, options.data_rng, options.seeded, options.seed, jobs_stopped);
+        if (!options.socket_path.empty())
+            return run_daemon(options.socket_path, num_threads, jobs_stopped);
+        return run_batch_mode(options.batch_path, num_threads, jobs_stopped);
+    }
 
-    if (is_sorted(num)) {
-        std::cout << "The number is sorted" << std::endl;
+    // A resumed search brings its own number and thread count, and keeps
+    // checkpointing to the file it came from unless told otherwise.
+    Checkpoint resume;
+    bool resuming = !options.resume_path.empty();
+    if (resuming) {
+        if (!load_checkpoint(options.resume_path, resume)) {
+            std::cout << "Failed to load checkpoint " << options.resume_path << std::endl;
+            return 1;
+        }
+        options.inputs.assign(1, resume.input);
+        if (!options.threads)
+            options.threads = resume.threads;
+        if (options.checkpoint_path.empty())
+            options.checkpoint_path = options.resume_path;
     }
-    else {
-        int num_threads = 8;
 
-        std::cout << "Enter the number of threads to use (1 for single-threaded): ";
-        std::cin >> num_threads;
+    std::vector<std::string> inputs = options.inputs;
+    if (inputs.empty()) {
+        std::string input;
+        std::cout << "Enter a number: ";
+        std::cin >> input;
+        inputs.push_back(input);
+    }
 
-        UI ui(SCREEN_W, SCREEN_H);
-        std::thread logic(logic_thread, num_threads, num, &ui);
+    std::vector<std::string> unsorted;
+    for (const std::string& input : inputs) {
+        if (digits_sorted(input.c_str(), input.size()))
+            std::cout << "The number " << input << " is sorted" << std::endl;
+        else
+            unsorted.push_back(input);
+    }
+
+    if (!unsorted.empty()) {
+        int num_threads = options.threads;
 
-        ui.update();
+        if (!num_threads) {
+            std::cout << "Enter the number of threads to use (1 for single-threaded): ";
+            std::cin >> num_threads;
+        }
+
+        if (num_threads < 1 || num_threads > MAX_THREADS) {
+            num_threads = std::max(1, std::min(num_threads, MAX_THREADS));
+            std::cout << "Using " << num_threads << " threads." << std::endl;
+        }
 
-        ui.draw();
+        // Workers start before SDL is touched; the window attaches to the
+        // running searches once it is up.
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (const std::string& input : unsorted) {
+                engines.emplace_back(new SearchEngine(input));
+                bool first = engines.size() == 1;
+
+                engines.back()->set_mode(options.mode);
+                if (options.seeded)
+                    engines.back()->set_seed(options.seed);
+                if (options.replay)
+                    engines.back()->search().control.kernel.store(static_cast<int>(Kernel::Replayable));
+
+                // Checkpoints cover the first number only.
+                if (first && resuming)
+                    engines.back()->resume(resume);
+                if (first && !options.checkpoint_path.empty())
+                    engines.back()->enable_checkpoints(options.checkpoint_path, std::chrono::seconds(options.checkpoint_seconds));
+
+                {
+                    std::lock_guard<std::mutex> console(console_mutex());
+                    if (first && resuming)
+                        std::cout << std::endl << "Resuming " << input << " from " << options.resume_path << " after "
+                            << engines.back()->search().stats.total_iterations.load() << " iterations." << std::endl;
+                    std::cout << std::endl << "Starting " << num_threads << " threads to find the sorted number for " << input << "." << std::endl;
+                    const Odds& odds = engines.back()->search().stats.odds;
+                    if (options.mode == Mode::Lehmer || options.mode == Mode::Heap)
+                        std::cout << "Enumerating up to " << odds.permutations << " permutations." << std::endl;
+                    if (options.mode == Mode::Multiset)
+                        std::cout << "Walking " << odds.distinct << " distinct arrangements instead of " << odds.permutations
+                            << " permutations, " << odds.repeats << "x fewer." << std::endl;
+                    std::cout << std::endl;
+                }
+                engines.back()->start(num_threads, report_search);
+            }
+        }
+
+        Search* primary = &engines.front()->search();
+
+        if (options.terminal) {
+            TerminalUI terminal(&primary->stats);
+            terminal.update();
+        }
+        else {
+            UI ui(SCREEN_W, SCREEN_H);
+            for (auto& engine : engines) {
+                ui.add_search(&engine->search().stats, engine->search().input);
+            }
+            ui.control = &primary->control;
+            if (options.replay)
+                ui.enable_replay(primary->input, primary->seed);
+            if (!options.capture_path.empty())
+                ui.start_capture(options.capture_path);
+
+            ui.update();
+
+            ui.draw();
+
+            // Closing the window ends the search like Ctrl+C does.
+            stop_all_searches();
+        }
+
+        for (auto& engine : engines) {
+            engine->join();
+        }
     }
 
     return 0;
 }
 
-int __stdcall wmain(int argc, char* argv[])
+// wmain receives UTF-16 arguments; _main works on UTF-8.
+int utf8_main(int argc, wchar_t* argv[])
+{
+    std::vector<std::string> args(argc);
+    std::vector<char*> pointers(argc + 1, nullptr);
+
+    for (int i = 0; i < argc; ++i) {
+        int size = WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, nullptr, 0, nullptr, nullptr);
+        args[i].resize(size > 0 ? size : 1);
+        WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, &args[i][0], size, nullptr, nullptr);
+        args[i].resize(args[i].size() - 1);
+        pointers[i] = &args[i][0];
+    }
+
+    return _main(argc, pointers.data());
+}
+
+int __stdcall wmain(int argc, wchar_t* argv[])
 {
     __security_init_cookie();
     int result = -1;
     __try
     {
-        result = _main(argc, argv);
+        result = utf8_main(argc, argv);
     }
     __except (EXCEPTION_EXECUTE_HANDLER)
     {
@@ -1,3 +1,222 @@
 #pragma once
 
-// #define USE_IMGUI 1;
\ No newline at end of file
+// #define USE_IMGUI 1;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <malloc.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engine/modes.h"
+#include "engine/odds.h"
+#include "engine/rng.h"
+#include "ui/sample_ring.h"
+
+const int MAX_THREADS = 64;
+const size_t SAMPLE_CAPACITY = 1024;
+
+// Digit-position histogram: only the first HEATMAP_POSITIONS positions are
+// tracked, and only every HEATMAP_STRIDE-th attempt (a power of two).
+const int HEATMAP_POSITIONS = 32;
+const uint64_t HEATMAP_STRIDE = 64;
+
+// Each worker owns one of these, padded so counters never share a cache line.
+// Only the owning worker writes, so plain load/store is enough; readers may
+// see a histogram that is a few updates behind.
+// best_prefix is the longest run of leading digits in sorted order (either
+// direction) seen among the sampled attempts. inversions is how far an
+// annealing worker's permutation is from sorted, updated once per batch.
+struct alignas(64) ThreadCounter {
+    std::atomic<uint64_t> iterations{ 0 };
+    std::atomic<uint32_t> best_prefix{ 0 };
+    std::atomic<uint64_t> inversions{ 0 };
+    std::atomic<uint32_t> digit_positions[HEATMAP_POSITIONS][10]{};
+};
+
+// Throughput for one sampling tick.
+struct Sample {
+    float seconds;
+    float total_ips;
+    float frame_ms;
+    int threads;
+    float thread_ips[MAX_THREADS];
+};
+
+// Live counters shared between the workers, the engine's logic thread and
+// the UI.
+// Workers never touch the UI; it reads everything it shows from here, so the
+// search can run before a window exists, or without one.
+struct SearchStats {
+    ThreadCounter threads[MAX_THREADS];
+    SampleRing<Sample, SAMPLE_CAPACITY> samples;
+    std::atomic<float> frame_ms{ 0.0f };
+    std::atomic<uint64_t> total_iterations{ 0 };
+    std::atomic<bool> success{ false };
+    std::atomic<bool> stopped{ false };
+    Odds odds;
+
+    // Inversions in the input for the closer order; set before start in
+    // annealing mode only, 0 otherwise.
+    uint64_t initial_inversions = 0;
+
+    // Set before start. odds, its percentile and the ETAs to it assume
+    // independent uniform shuffles, so only Mode::Shuffle sets
+    // shuffle_odds. The enumerations set enumeration_size instead, how many
+    // arrangements they walk at most once: n! for Lehmer and Heap, the
+    // distinct ones for Multiset. The other modes get neither.
+    bool shuffle_odds = false;
+    double enumeration_size = 0.0;
+
+    // Hybrid mode only: chunks bogosorted (set before start), and how long
+    // the bogo and merge phases took in microseconds, -1 until each is done.
+    uint32_t hybrid_chunks = 0;
+    std::atomic<int64_t> bogo_phase_us{ -1 };
+    std::atomic<int64_t> merge_phase_us{ -1 };
+
+    // Least inversions any annealing worker is at right now.
+    uint64_t inversions_left()
+    {
+        uint64_t least = initial_inversions;
+        for (const ThreadCounter& counter : threads) {
+            if (counter.iterations.load(std::memory_order_relaxed))
+                least = std::min(least, counter.inversions.load(std::memory_order_relaxed));
+        }
+        return least;
+    }
+
+    // Set once before any worker starts; startup latencies are measured
+    // from here in microseconds, -1 until they happen.
+    std::chrono::steady_clock::time_point start_time;
+    std::atomic<int64_t> first_iteration_us{ -1 };
+    std::atomic<int64_t> first_frame_us{ -1 };
+
+    // Filled in by the worker that finds the sorted number (winner stays -1
+    // if the search is stopped first) and by the engine once every worker
+    // has exited; end_time is only valid after finished is set.
+    std::atomic<int> winner{ -1 };
+    std::atomic<uint64_t> winner_iterations{ 0 };
+    std::atomic<bool> finished{ false };
+    std::chrono::steady_clock::time_point end_time;
+
+    // Deterministic searches only. The earliest find so far as
+    // iteration * MAX_THREADS + thread, so the smaller key wins and equal
+    // iterations go to the lower thread; best_number is guarded by
+    // snapshot_mutex.
+    std::atomic<uint64_t> best_key{ UINT64_MAX };
+    std::string best_number;
+
+    std::atomic<uint64_t> checkpoints{ 0 };
+    std::atomic<uint64_t> checkpoint_failures{ 0 };
+
+    // Latest permutation for display. Workers publish with try_lock and
+    // skip the update if a reader holds the lock. The final publish of the
+    // sorted number waits for the lock and sets success under it, so no
+    // later publish from a slower worker can replace it.
+    std::mutex snapshot_mutex;
+    std::string snapshot;
+
+    void publish(const char* num, bool final)
+    {
+        std::unique_lock<std::mutex> lock(snapshot_mutex, std::defer_lock);
+        if (final)
+            lock.lock();
+        else if (!lock.try_lock())
+            return;
+        if (success.load())
+            return;
+        snapshot.assign(num);
+        if (final)
+            success.store(true);
+    }
+
+    std::string read_snapshot()
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        return snapshot;
+    }
+
+    void mark(std::atomic<int64_t>& event)
+    {
+        int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+        int64_t unset = -1;
+        event.compare_exchange_strong(unset, elapsed);
+    }
+};
+
+// Settings the UI can change on a running search. kernel and rng hold Kernel
+// and RngPolicy values and are picked up by each worker at its next batch.
+// requested_threads is applied by the logic thread, which alone owns
+// active_threads.
+struct SearchControl {
+    std::atomic<int> kernel{ 0 };
+    std::atomic<int> rng{ 0 };
+    std::atomic<int> requested_threads{ 1 };
+    std::atomic<int> active_threads{ 0 };
+};
+
+// A worker's state as of its last batch boundary, copied out for
+// checkpoints. The worker copies only when checkpoint_epoch has moved past
+// epoch, and once more as it exits. saved is set by either copy and by
+// resuming; once it is, a worker started on the slot continues from rng
+// instead of seeding.
+struct WorkerSnapshot {
+    std::mutex mutex;
+    std::atomic<uint64_t> epoch{ 0 };
+    bool saved = false;
+    uint64_t iterations = 0;
+    std::string permutation;
+    ThreadRng rng;
+};
+
+class PrefixDispenser;
+class RankDispenser;
+
+// Everything one running search owns. Several can run side by side.
+struct Search {
+    explicit Search(const std::string& input) : input(input), thread_numbers(MAX_THREADS, input) {}
+
+    // SearchStats holds cache line aligned counters, which plain new does
+    // not guarantee before C++17.
+    static void* operator new(size_t size) { return _aligned_malloc(size, alignof(Search)); }
+    static void operator delete(void* p) { _aligned_free(p); }
+
+    std::string input;
+    SearchStats stats;
+    SearchControl control;
+
+    // Guards the stop notification; stats.stopped is the flag itself.
+    std::mutex mtx;
+    std::condition_variable stopped_cv;
+
+    // One buffer per worker slot. They outlive the threads, so a worker
+    // that is stopped and later restarted carries on from its last
+    // permutation.
+    std::vector<std::string> thread_numbers;
+
+    // Every worker's RNG comes from seed. A deterministic search also picks
+    // its winner by (iteration, thread) instead of by whoever finishes
+    // first, so the same seed and thread count give the same result.
+    uint64_t seed = 0;
+    bool deterministic = false;
+
+    std::atomic<uint64_t> checkpoint_epoch{ 0 };
+    WorkerSnapshot workers[MAX_THREADS];
+
+    // The body of each worker thread, given the search and its slot. It
+    // runs until stats.stopped is set or the slot is at or above
+    // control.active_threads, counting into stats.threads[slot].
+    std::function<void(Search*, int)> worker;
+
+    // Set before start. ranks exists only in Lehmer mode, prefixes in
+    // Multiset and Heap mode.
+    Mode mode = Mode::Shuffle;
+    std::shared_ptr<RankDispenser> ranks;
+    std::shared_ptr<PrefixDispenser> prefixes;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <mutex>
+
+// Serialises console output between searches, batch jobs, the daemon and
+// the terminal dashboard. Only the console front end uses it; the engine
+// never writes to the console.
+inline std::mutex& console_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
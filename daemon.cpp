@@ -0,0 +1,244 @@
+#include "daemon.h"
+
+#include <winsock2.h>
+#include <afunix.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "console.h"
+#include "engine/job_runner.h"
+
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace {
+
+const int POLL_MS = 200;
+
+struct Client {
+    std::thread thread;
+    std::shared_ptr<std::atomic<bool>> done;
+};
+
+// Waits until socket has data or a pending connection, giving up once stop
+// is set. select() is used instead of a blocking call so shutdown is seen.
+bool wait_readable(SOCKET socket, const std::atomic<bool>& stop)
+{
+    while (!stop.load()) {
+        fd_set set;
+        FD_ZERO(&set);
+        FD_SET(socket, &set);
+        timeval timeout = { 0, POLL_MS * 1000 };
+
+        int ready = select(static_cast<int>(socket) + 1, &set, nullptr, nullptr, &timeout);
+        if (ready == SOCKET_ERROR)
+            return false;
+        if (ready > 0)
+            return true;
+    }
+
+    return false;
+}
+
+bool send_line(SOCKET socket, std::string line)
+{
+    line += '\n';
+    size_t sent = 0;
+    while (sent < line.size()) {
+        int result = send(socket, line.data() + sent, static_cast<int>(line.size() - sent), 0);
+        if (result == SOCKET_ERROR)
+            return false;
+        sent += result;
+    }
+    return true;
+}
+
+std::string format_status(const JobStatus& status)
+{
+    std::ostringstream out;
+    out << JOB_STATE_NAMES[static_cast<int>(status.state)] << ' ' << status.id << ' ' << status.input
+        << ' ' << status.iterations << ' ' << status.seconds;
+    if (status.state == JobState::Sorted)
+        out << ' ' << status.result;
+    return out.str();
+}
+
+bool parse_number(const std::string& arg)
+{
+    return !arg.empty() && arg.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// Returns the reply to one request line. Sets close when the connection
+// should end after the reply.
+std::string handle_request(const std::string& line, JobRunner& runner, std::atomic<bool>& stop, bool& close)
+{
+    std::istringstream in(line);
+    std::string command, arg;
+    in >> command >> arg;
+
+    if ((command == "submit" || command == "sort") && parse_number(arg)) {
+        uint64_t id = runner.submit(arg);
+        if (command == "submit")
+            return "ok " + std::to_string(id);
+
+        JobStatus status;
+        runner.wait(id, status);
+        return format_status(status);
+    }
+
+    if ((command == "status" || command == "cancel") && parse_number(arg)) {
+        uint64_t id = std::strtoull(arg.c_str(), nullptr, 10);
+        JobStatus status;
+        if (command == "status" ? !runner.status(id, status) : !runner.cancel(id))
+            return "error unknown job " + arg;
+        return command == "status" ? format_status(status) : "ok " + arg;
+    }
+
+    if (command == "stats") {
+        WorkerPool::WorkerStats sum = { 0, 0, 0, 0.0 };
+        for (const WorkerPool::WorkerStats& worker : runner.worker_stats()) {
+            sum.tasks += worker.tasks;
+            sum.steals += worker.steals;
+            sum.idle_seconds += worker.idle_seconds;
+        }
+
+        std::ostringstream out;
+        out << "threads " << runner.threads() << " tasks " << sum.tasks << " steals " << sum.steals << " idle " << sum.idle_seconds;
+        return out.str();
+    }
+
+    if (command == "quit") {
+        close = true;
+        return "ok";
+    }
+
+    if (command == "shutdown") {
+        close = true;
+        stop.store(true);
+        return "ok";
+    }
+
+    return "error bad request: " + line;
+}
+
+void serve_client(SOCKET client, JobRunner& runner, std::atomic<bool>& stop)
+{
+    std::string buffer;
+    char chunk[512];
+    bool close = false;
+
+    while (!close && wait_readable(client, stop)) {
+        int received = recv(client, chunk, sizeof(chunk), 0);
+        if (received <= 0)
+            break;
+        buffer.append(chunk, received);
+
+        size_t end;
+        while (!close && (end = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, end);
+            buffer.erase(0, end + 1);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.empty())
+                continue;
+
+            if (!send_line(client, handle_request(line, runner, stop, close)))
+                close = true;
+        }
+    }
+
+    closesocket(client);
+}
+
+}
+
+int run_daemon(const std::string& socket_path, int threads, std::atomic<bool>& stop)
+{
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cout << "Failed to initialize Winsock" << std::endl;
+        return 1;
+    }
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cout << "Socket path is too long: " << socket_path << std::endl;
+        WSACleanup();
+        return 1;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    // A socket file left behind by an earlier run would make bind fail.
+    std::remove(socket_path.c_str());
+
+    SOCKET listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == INVALID_SOCKET
+        || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR
+        || listen(listener, SOMAXCONN) == SOCKET_ERROR) {
+        std::cout << "Failed to listen on " << socket_path << " (error " << WSAGetLastError() << ")" << std::endl;
+        if (listener != INVALID_SOCKET)
+            closesocket(listener);
+        WSACleanup();
+        return 1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(console_mutex());
+        std::cout << "Listening on " << socket_path << " with " << threads << " threads." << std::endl;
+    }
+
+    {
+        JobRunner runner(threads, stop);
+        std::vector<Client> clients;
+
+        while (wait_readable(listener, stop)) {
+            SOCKET socket = accept(listener, nullptr, nullptr);
+            if (socket == INVALID_SOCKET)
+                continue;
+
+            // Reap connections that have closed so the list stays short.
+            for (auto it = clients.begin(); it != clients.end();) {
+                if (it->done->load()) {
+                    it->thread.join();
+                    it = clients.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+
+            Client client;
+            client.done = std::make_shared<std::atomic<bool>>(false);
+            std::shared_ptr<std::atomic<bool>> done = client.done;
+            client.thread = std::thread([socket, done, &runner, &stop] {
+                serve_client(socket, runner, stop);
+                done->store(true);
+            });
+            clients.push_back(std::move(client));
+        }
+
+        stop.store(true);
+
+        // Clients notice stop within one poll; a client blocked in sort
+        // returns as soon as the runner cancels its job.
+        for (Client& client : clients) {
+            client.thread.join();
+        }
+    }
+
+    closesocket(listener);
+    std::remove(socket_path.c_str());
+    WSACleanup();
+
+    std::lock_guard<std::mutex> lock(console_mutex());
+    std::cout << "Daemon stopped." << std::endl;
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+// Serves sort jobs over a Unix domain socket at socket_path until stop is
+// set, from Ctrl+C or a client's shutdown request. The worker pool and its
+// per-thread RNGs stay up for the whole run, so a request only costs a
+// queue push. The protocol is one text line per request and per reply:
+//
+//   submit <number>   ok <id>
+//   sort <number>     waits, then replies like status
+//   status <id>       <state> <id> <number> <iterations> <seconds> [<result>]
+//   cancel <id>       ok <id>
+//   stats             threads <n> tasks <n> steals <n> idle <seconds>
+//   quit              closes the connection
+//   shutdown          stops the daemon
+//
+// Anything that fails replies "error <reason>". Returns non-zero if the
+// socket could not be set up.
+int run_daemon(const std::string& socket_path, int threads, std::atomic<bool>& stop);
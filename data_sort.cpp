@@ -0,0 +1,189 @@
+#include "data_sort.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "engine/generic_engine.h"
+
+namespace {
+
+const std::chrono::milliseconds POLL_INTERVAL(10);
+
+bool parse_value(const std::string& token, uint8_t& value)
+{
+    char* end;
+    unsigned long parsed = std::strtoul(token.c_str(), &end, 10);
+    value = static_cast<uint8_t>(parsed);
+    return *end == '\0' && parsed <= 255;
+}
+
+bool parse_value(const std::string& token, int32_t& value)
+{
+    char* end;
+    errno = 0;
+    long long parsed = std::strtoll(token.c_str(), &end, 10);
+    value = static_cast<int32_t>(parsed);
+    return *end == '\0' && errno == 0 && parsed >= std::numeric_limits<int32_t>::min() && parsed <= std::numeric_limits<int32_t>::max();
+}
+
+bool parse_value(const std::string& token, int64_t& value)
+{
+    char* end;
+    errno = 0;
+    value = std::strtoll(token.c_str(), &end, 10);
+    return *end == '\0' && errno == 0;
+}
+
+bool parse_value(const std::string& token, float& value)
+{
+    char* end;
+    value = std::strtof(token.c_str(), &end);
+    return *end == '\0';
+}
+
+bool parse_value(const std::string& token, double& value)
+{
+    char* end;
+    value = std::strtod(token.c_str(), &end);
+    return *end == '\0';
+}
+
+template <size_t N>
+bool parse_value(const std::string& token, FixedString<N>& value)
+{
+    std::memset(value.bytes, 0, N);
+    std::memcpy(value.bytes, token.data(), std::min(token.size(), N));
+    return token.size() <= N;
+}
+
+template <typename T>
+void print_value(const T& value)
+{
+    std::cout << value;
+}
+
+// The default 6 significant digits would print distinct values alike.
+template <typename T>
+void print_float(T value)
+{
+    std::streamsize precision = std::cout.precision(std::numeric_limits<T>::max_digits10);
+    std::cout << value;
+    std::cout.precision(precision);
+}
+
+void print_value(const float& value)
+{
+    print_float(value);
+}
+
+void print_value(const double& value)
+{
+    print_float(value);
+}
+
+void print_value(const uint8_t& value)
+{
+    std::cout << static_cast<int>(value);
+}
+
+template <size_t N>
+void print_value(const FixedString<N>& value)
+{
+    std::cout.write(value.bytes, std::find(value.bytes, value.bytes + N, '\0') - value.bytes);
+}
+
+template <typename T>
+int sort_values(std::istream& in, const std::string& element, int threads, RngPolicy rng, bool seeded, uint64_t seed, const std::atomic<bool>& cancel)
+{
+    std::vector<T> values;
+    std::vector<typename ElementTraits<T>::Key> keys;
+    std::string token;
+    while (in >> token) {
+        T value;
+        if (!parse_value(token, value)) {
+            std::cout << "Not a valid " << element << " value: " << token << std::endl;
+            return 1;
+        }
+        values.push_back(value);
+        keys.push_back(ElementTraits<T>::to_key(value));
+    }
+
+    if (keys_sorted(keys.data(), keys.size(), KeyLess<ElementTraits<T>>())) {
+        std::cout << "The " << values.size() << " values are sorted" << std::endl;
+        return 0;
+    }
+
+    GenericEngine<T> engine(values);
+    engine.set_rng(rng);
+    if (seeded)
+        engine.set_seed(seed);
+
+    std::cout << "Starting " << threads << " threads to bogosort " << values.size() << " " << element << " values." << std::endl;
+    engine.start(threads);
+
+    SearchStats& stats = engine.stats();
+    while (!stats.finished.load() && !cancel.load()) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+    engine.stop();
+    engine.join();
+
+    if (stats.success.load()) {
+        std::cout << "Thread " << stats.winner.load() << " found the sorted order after " << stats.winner_iterations.load() << " iterations:";
+        for (const T& value : engine.result()) {
+            std::cout << " ";
+            print_value(value);
+        }
+        std::cout << std::endl;
+    }
+    else {
+        std::cout << "Stopped before the values were sorted." << std::endl;
+    }
+
+    double elapsed = std::chrono::duration<double>(stats.end_time - stats.start_time).count();
+    uint64_t attempts = stats.total_iterations.load();
+    std::cout << "Total iterations for all threads: " << attempts << std::endl;
+    std::cout << "Average iterations per second: " << (elapsed > 0.0 ? attempts / elapsed : 0.0) << std::endl;
+    std::cout << "Total time: " << elapsed << " s" << std::endl;
+    return 0;
+}
+
+}
+
+int run_data_sort(const std::string& path, const std::string& element, int threads, RngPolicy rng,
+    bool seeded, uint64_t seed, const std::atomic<bool>& cancel)
+{
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Failed to open " << path << std::endl;
+        return 1;
+    }
+
+    if (element == "u8")
+        return sort_values<uint8_t>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "i32")
+        return sort_values<int32_t>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "i64")
+        return sort_values<int64_t>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "f32")
+        return sort_values<float>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "f64")
+        return sort_values<double>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "str8")
+        return sort_values<FixedString<8>>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "str16")
+        return sort_values<FixedString<16>>(file, element, threads, rng, seeded, seed, cancel);
+    if (element == "str32")
+        return sort_values<FixedString<32>>(file, element, threads, rng, seeded, seed, cancel);
+
+    std::cout << "Unknown element type: " << element << std::endl;
+    return 1;
+}
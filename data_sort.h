@@ -0,0 +1,15 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "engine/rng.h"
+
+// Bogosorts the whitespace separated values in path as element, one of
+// u8, i32, i64, f32, f64, str8, str16 or str32, with threads workers drawing
+// from rng, and prints them in order with the search's statistics. Floats
+// print with enough digits to read back exactly. seeded applies seed.
+// Returns non-zero on an unknown type, an unreadable file or a bad value.
+int run_data_sort(const std::string& path, const std::string& element, int threads, RngPolicy rng,
+    bool seeded, uint64_t seed, const std::atomic<bool>& cancel);
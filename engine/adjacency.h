@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Counts the adjacent pairs of a digit string that break ascending order
+// (descents) and those that break descending order (ascents). The string is
+// sorted in some direction when either count is zero, so a walk that only
+// ever swaps two digits can test every arrangement in O(1) instead of
+// rescanning it.
+class AdjacencyTracker
+{
+public:
+    void reset(const char* a, size_t length)
+    {
+        m_length = length;
+        m_descents = 0;
+        m_ascents = 0;
+        for (size_t k = 0; k + 1 < length; ++k) {
+            count(a, k, 1);
+        }
+    }
+
+    // Swaps a[x] and a[y], recounting only the up to four pairs that touch
+    // them.
+    void swap(char* a, size_t x, size_t y)
+    {
+        size_t pairs[4];
+        int touched = 0;
+        auto touch = [&](size_t k) {
+            if (k + 1 < m_length && std::find(pairs, pairs + touched, k) == pairs + touched)
+                pairs[touched++] = k;
+        };
+        if (x > 0)
+            touch(x - 1);
+        touch(x);
+        if (y > 0)
+            touch(y - 1);
+        touch(y);
+
+        for (int i = 0; i < touched; ++i) {
+            count(a, pairs[i], -1);
+        }
+        std::swap(a[x], a[y]);
+        for (int i = 0; i < touched; ++i) {
+            count(a, pairs[i], 1);
+        }
+    }
+
+    bool sorted() const { return m_descents == 0 || m_ascents == 0; }
+
+    // Pairs out of place for the closer of the two orders.
+    uint32_t misplaced() const { return static_cast<uint32_t>(std::min(m_descents, m_ascents)); }
+
+private:
+    void count(const char* a, size_t k, int sign)
+    {
+        m_descents += sign * (a[k] > a[k + 1]);
+        m_ascents += sign * (a[k] < a[k + 1]);
+    }
+
+    size_t m_length = 0;
+    int64_t m_descents = 0;
+    int64_t m_ascents = 0;
+};
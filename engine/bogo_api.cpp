@@ -0,0 +1,222 @@
+#include "bogo_api.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "kernels.h"
+#include "rng.h"
+#include "search_engine.h"
+
+static_assert(BOGO_KERNEL_REPLAYABLE == static_cast<int>(Kernel::Replayable), "kernel ids must match Kernel");
+static_assert(BOGO_MODE_HYBRID == static_cast<int>(Mode::Hybrid), "mode ids must match Mode");
+static_assert(BOGO_RNG_XOSHIRO256 == static_cast<int>(RngPolicy::Xoshiro256), "rng ids must match RngPolicy");
+
+struct bogo_engine {
+    std::mutex mutex;
+    int threads = 1;
+    int kernel = BOGO_KERNEL_LEGACY;
+    int rng = BOGO_RNG_CRAND;
+    int mode = BOGO_MODE_SHUFFLE;
+    bool seeded = false;
+    uint64_t seed = 0;
+    std::unique_ptr<SearchEngine> search;
+};
+
+namespace {
+
+bool is_running(const bogo_engine& engine)
+{
+    return engine.search && !engine.search->search().stats.finished.load();
+}
+
+}
+
+bogo_engine* bogo_create(void)
+{
+    return new bogo_engine();
+}
+
+void bogo_destroy(bogo_engine* engine)
+{
+    delete engine;
+}
+
+int bogo_set_threads(bogo_engine* engine, int threads)
+{
+    if (!engine || threads < 1 || threads > MAX_THREADS)
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->threads = threads;
+    if (engine->search)
+        engine->search->search().control.requested_threads.store(threads);
+    return BOGO_OK;
+}
+
+int bogo_set_kernel(bogo_engine* engine, int kernel)
+{
+    if (!engine || kernel < 0 || kernel >= static_cast<int>(Kernel::Count))
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->kernel = kernel;
+    if (engine->search)
+        engine->search->search().control.kernel.store(kernel);
+    return BOGO_OK;
+}
+
+int bogo_set_rng(bogo_engine* engine, int rng)
+{
+    if (!engine || rng < 0 || rng >= static_cast<int>(RngPolicy::Count))
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->rng = rng;
+    if (engine->search)
+        engine->search->search().control.rng.store(rng);
+    return BOGO_OK;
+}
+
+int bogo_set_mode(bogo_engine* engine, int mode)
+{
+    if (!engine || mode < 0 || mode >= static_cast<int>(Mode::Count))
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->mode = mode;
+    return BOGO_OK;
+}
+
+int bogo_set_seed(bogo_engine* engine, uint64_t master)
+{
+    if (!engine)
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    engine->seeded = true;
+    engine->seed = master;
+    return BOGO_OK;
+}
+
+int bogo_submit(bogo_engine* engine, const char* digits)
+{
+    if (!engine || !digits || !*digits || std::strspn(digits, "0123456789") != std::strlen(digits))
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (is_running(*engine))
+        return BOGO_ERROR_STATE;
+
+    // The previous search has finished; its threads are joined here.
+    engine->search.reset(new SearchEngine(digits));
+    SearchControl& control = engine->search->search().control;
+    control.kernel.store(engine->kernel);
+    control.rng.store(engine->rng);
+    engine->search->set_mode(static_cast<Mode>(engine->mode));
+    if (engine->seeded)
+        engine->search->set_seed(engine->seed);
+
+    // An input that is already sorted never reaches a worker.
+    if (digits_sorted(digits, std::strlen(digits))) {
+        SearchStats& stats = engine->search->search().stats;
+        stats.start_time = stats.end_time = std::chrono::steady_clock::now();
+        stats.publish(digits, true);
+        stats.stopped.store(true);
+        stats.finished.store(true);
+        return BOGO_OK;
+    }
+
+    engine->search->start(engine->threads);
+    return BOGO_OK;
+}
+
+int bogo_poll(bogo_engine* engine, bogo_stats* out)
+{
+    if (!engine || !out)
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    std::memset(out, 0, sizeof(*out));
+    out->state = BOGO_STATE_IDLE;
+    out->threads = engine->threads;
+    if (!engine->search)
+        return BOGO_OK;
+
+    Search& search = engine->search->search();
+    SearchStats& stats = search.stats;
+    bool finished = stats.finished.load();
+
+    // A seeded search stops its workers on its first find but only picks
+    // and publishes the winner once they have all exited, so stopped alone
+    // says nothing about the outcome.
+    if (!finished)
+        out->state = BOGO_STATE_RUNNING;
+    else if (stats.success.load())
+        out->state = BOGO_STATE_SORTED;
+    else
+        out->state = BOGO_STATE_CANCELLED;
+
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        out->total_iterations += stats.threads[i].iterations.load(std::memory_order_relaxed);
+    }
+
+    Sample sample;
+    if (!finished && stats.samples.latest(sample))
+        out->iterations_per_second = sample.total_ips;
+
+    std::chrono::steady_clock::time_point end = finished ? stats.end_time : std::chrono::steady_clock::now();
+    out->elapsed_seconds = std::chrono::duration<double>(end - stats.start_time).count();
+    out->expected_attempts = stats.odds.expected_attempts;
+    out->success_probability = stats.odds.probability;
+    out->inversions_left = stats.success.load() ? 0 : stats.inversions_left();
+    out->percentile = success_percentile(stats.odds, static_cast<double>(out->total_iterations));
+    out->threads = finished ? search.control.active_threads.load() : search.control.requested_threads.load();
+    return BOGO_OK;
+}
+
+int bogo_current(bogo_engine* engine, char* buffer, size_t size)
+{
+    if (!engine || !buffer)
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (!engine->search)
+        return BOGO_ERROR_STATE;
+
+    std::string current = engine->search->search().stats.read_snapshot();
+    if (current.size() + 1 > size)
+        return BOGO_ERROR_BUFFER;
+
+    std::memcpy(buffer, current.c_str(), current.size() + 1);
+    return BOGO_OK;
+}
+
+int bogo_cancel(bogo_engine* engine)
+{
+    if (!engine)
+        return BOGO_ERROR_ARGUMENT;
+
+    std::lock_guard<std::mutex> lock(engine->mutex);
+    if (!engine->search)
+        return BOGO_ERROR_STATE;
+
+    engine->search->stop();
+    return BOGO_OK;
+}
+
+int bogo_replay(const char* digits, uint64_t seed, int thread, uint64_t attempt, char* buffer, size_t size)
+{
+    if (!digits || !buffer || thread < 0 || thread >= MAX_THREADS || attempt == 0)
+        return BOGO_ERROR_ARGUMENT;
+
+    size_t length = std::strlen(digits);
+    if (length + 1 > size)
+        return BOGO_ERROR_BUFFER;
+
+    ReplayKey key = { digits, seed, static_cast<uint32_t>(thread) };
+    replay_attempt(buffer, length, key, attempt);
+    buffer[length] = '\0';
+    return BOGO_OK;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C interface to the search engine, for embedding it in another process.
+ * The library keeps no global state and never writes to the console: all
+ * state lives in the bogo_engine handle, and every function reports
+ * failure through its return value. A handle may be used from several
+ * threads at once.
+ */
+
+#if defined(BOGO_BUILD_DLL)
+#define BOGO_API __declspec(dllexport)
+#elif defined(BOGO_USE_DLL)
+#define BOGO_API __declspec(dllimport)
+#else
+#define BOGO_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct bogo_engine bogo_engine;
+
+enum {
+    BOGO_OK = 0,
+    BOGO_ERROR_ARGUMENT = -1,   /* null handle, bad number or out of range setting */
+    BOGO_ERROR_STATE = -2,      /* nothing submitted yet, or a search is already running */
+    BOGO_ERROR_BUFFER = -3      /* output buffer too small */
+};
+
+enum {
+    BOGO_KERNEL_LEGACY = 0,
+    BOGO_KERNEL_FISHER_YATES = 1,
+    BOGO_KERNEL_REPLAYABLE = 2      /* counter-based; any attempt can be rebuilt with bogo_replay */
+};
+
+enum {
+    BOGO_RNG_CRAND = 0,
+    BOGO_RNG_MT19937 = 1,
+    BOGO_RNG_XOSHIRO256 = 2
+};
+
+enum {
+    BOGO_MODE_SHUFFLE = 0,
+    BOGO_MODE_LEHMER = 1,           /* disjoint permutation ranks per thread, at most n! attempts */
+    BOGO_MODE_MULTISET = 2,         /* distinct arrangements only, at most n! / prod(ci!) attempts */
+    BOGO_MODE_HEAP = 3,             /* Heap's algorithm per prefix, one swap and an O(1) test per attempt */
+    BOGO_MODE_BOZO = 4,             /* swap two random digits per attempt, O(1) at any length */
+    BOGO_MODE_ANNEAL = 5,           /* random swaps kept by simulated annealing on the inversion count */
+    BOGO_MODE_FROZEN = 6,           /* digits in their sorted place are locked, only the rest are shuffled */
+    BOGO_MODE_HYBRID = 7            /* short chunks bogosorted in parallel, then merged */
+};
+
+enum {
+    BOGO_STATE_IDLE = 0,
+    BOGO_STATE_RUNNING = 1,
+    BOGO_STATE_SORTED = 2,
+    BOGO_STATE_CANCELLED = 3
+};
+
+typedef struct bogo_stats {
+    int state;
+    int threads;
+    uint64_t total_iterations;
+    double iterations_per_second;   /* over the latest 100 ms sample */
+    double elapsed_seconds;
+    double expected_attempts;
+    double success_probability;     /* exact chance one attempt sorts the number */
+    double percentile;              /* chance the search would have succeeded by now */
+    uint64_t inversions_left;       /* BOGO_MODE_ANNEAL only: the closest worker's distance from sorted */
+} bogo_stats;
+
+BOGO_API bogo_engine* bogo_create(void);
+
+/* Cancels a running search and waits for its threads before freeing. */
+BOGO_API void bogo_destroy(bogo_engine* engine);
+
+/* Settings apply to the running search, if any, and to later submits. */
+BOGO_API int bogo_set_threads(bogo_engine* engine, int threads);
+BOGO_API int bogo_set_kernel(bogo_engine* engine, int kernel);
+BOGO_API int bogo_set_rng(bogo_engine* engine, int rng);
+
+/* Applies to later submits only. Seeds only affect BOGO_MODE_SHUFFLE,
+ * BOGO_MODE_BOZO, BOGO_MODE_ANNEAL, BOGO_MODE_FROZEN and BOGO_MODE_HYBRID. */
+BOGO_API int bogo_set_mode(bogo_engine* engine, int mode);
+
+/* Makes later submits reproducible: every worker's RNG stream is derived
+ * from master, and the winner is the earliest find by (iteration, thread)
+ * rather than the first in wall time. Does not affect a running search. */
+BOGO_API int bogo_set_seed(bogo_engine* engine, uint64_t master);
+
+/* Starts sorting digits, a NUL terminated string of decimal digits.
+ * Fails with BOGO_ERROR_STATE while an earlier search is still running. */
+BOGO_API int bogo_submit(bogo_engine* engine, const char* digits);
+
+/* state stays BOGO_STATE_RUNNING until every worker has exited, then
+ * becomes BOGO_STATE_SORTED or BOGO_STATE_CANCELLED for good. */
+BOGO_API int bogo_poll(bogo_engine* engine, bogo_stats* stats);
+
+/* Copies the latest permutation, or the sorted number once found. */
+BOGO_API int bogo_current(bogo_engine* engine, char* buffer, size_t size);
+
+BOGO_API int bogo_cancel(bogo_engine* engine);
+
+/* Rebuilds the permutation that thread tried at attempt (counting from 1)
+ * of a search on the replayable kernel with the given seed. Needs no
+ * engine; buffer must hold strlen(digits) + 1 bytes. */
+BOGO_API int bogo_replay(const char* digits, uint64_t seed, int thread, uint64_t attempt, char* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
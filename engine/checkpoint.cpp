@@ -0,0 +1,87 @@
+#include "checkpoint.h"
+
+#include <Windows.h>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const char* const CHECKPOINT_MAGIC = "bogo-checkpoint";
+const int CHECKPOINT_VERSION = 2;
+
+}
+
+// Text format, one record per line:
+//   bogo-checkpoint 2
+//   search <input> <kernel> <rng> <threads> <elapsed_us>
+//   seed <master> <deterministic> <best_key> [<best_number>]
+//   worker <slot> <iterations> <best_prefix> <permutation> <rng state...>
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint)
+{
+    std::string temp = path + ".tmp";
+
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        if (!out)
+            return false;
+
+        out << CHECKPOINT_MAGIC << ' ' << CHECKPOINT_VERSION << '\n';
+        out << "search " << checkpoint.input << ' ' << checkpoint.kernel << ' ' << checkpoint.rng << ' '
+            << checkpoint.threads << ' ' << checkpoint.elapsed_us << '\n';
+        out << "seed " << checkpoint.seed << ' ' << checkpoint.deterministic << ' ' << checkpoint.best_key;
+        if (!checkpoint.best_number.empty())
+            out << ' ' << checkpoint.best_number;
+        out << '\n';
+
+        for (const WorkerCheckpoint& worker : checkpoint.workers) {
+            out << "worker " << worker.slot << ' ' << worker.iterations << ' ' << worker.best_prefix << ' ' << worker.permutation << ' ';
+            worker.rng.save(out);
+            out << '\n';
+        }
+
+        out.flush();
+        if (!out)
+            return false;
+    }
+
+    return MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint)
+{
+    std::ifstream in(path);
+    std::string magic;
+    int version = 0;
+    if (!(in >> magic >> version) || magic != CHECKPOINT_MAGIC || version != CHECKPOINT_VERSION)
+        return false;
+
+    std::string record;
+    if (!(in >> record) || record != "search")
+        return false;
+    if (!(in >> checkpoint.input >> checkpoint.kernel >> checkpoint.rng >> checkpoint.threads >> checkpoint.elapsed_us))
+        return false;
+
+    std::string line;
+    std::getline(in, line);
+    if (!std::getline(in, line))
+        return false;
+    std::istringstream seed(line);
+    if (!(seed >> record >> checkpoint.seed >> checkpoint.deterministic >> checkpoint.best_key) || record != "seed")
+        return false;
+    seed >> checkpoint.best_number;
+
+    checkpoint.workers.clear();
+    while (in >> record) {
+        if (record != "worker")
+            return false;
+
+        WorkerCheckpoint worker;
+        if (!(in >> worker.slot >> worker.iterations >> worker.best_prefix >> worker.permutation) || !worker.rng.load(in))
+            return false;
+        if (worker.permutation.size() != checkpoint.input.size())
+            return false;
+        checkpoint.workers.push_back(worker);
+    }
+
+    return true;
+}
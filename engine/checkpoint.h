@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rng.h"
+
+// Everything needed to carry a search on after a restart. Only worker
+// slots that have run are stored.
+struct WorkerCheckpoint {
+    int slot = 0;
+    uint64_t iterations = 0;
+    uint32_t best_prefix = 0;
+    std::string permutation;
+    ThreadRng rng;
+};
+
+struct Checkpoint {
+    std::string input;
+    int kernel = 0;
+    int rng = 0;
+    int threads = 1;
+    int64_t elapsed_us = 0;
+    uint64_t seed = 0;
+    bool deterministic = false;
+    uint64_t best_key = UINT64_MAX;
+    std::string best_number;
+    std::vector<WorkerCheckpoint> workers;
+};
+
+// Writes to path + ".tmp" and renames it over path, so a crash mid-write
+// leaves the previous checkpoint intact.
+bool save_checkpoint(const std::string& path, const Checkpoint& checkpoint);
+
+// Returns false if the file is missing, from another version or damaged.
+bool load_checkpoint(const std::string& path, Checkpoint& checkpoint);
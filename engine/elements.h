@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+// Element types a search can sort, beyond decimal digits. Every type maps
+// to a Key with the order it is sorted by, and workers shuffle and test the
+// keys: the numeric types become unsigned integers ordered like the values,
+// so the sortedness test is a plain integer compare whatever the type, and
+// the keys map back once a search is done.
+//   char:            decimal digits, the classic search; the key is the digit.
+//   uint8_t:         bytes.
+//   int32_t/int64_t: the sign bit flipped, so negatives come first.
+//   float/double:    IEEE 754 totalOrder: -NaN < -inf < ... < -0 < +0 < ...
+//                    < +inf < +NaN, so NaNs and signed zeros sort too.
+//   FixedString<N>:  N bytes, zero padded, ordered by memcmp.
+template <typename T>
+struct ElementTraits;
+
+template <size_t N>
+struct FixedString {
+    char bytes[N];
+};
+
+template <>
+struct ElementTraits<char> {
+    typedef char Key;
+    static Key to_key(char value) { return value; }
+    static char from_key(Key key) { return key; }
+    static bool less(Key a, Key b) { return a < b; }
+};
+
+template <>
+struct ElementTraits<uint8_t> {
+    typedef uint8_t Key;
+    static Key to_key(uint8_t value) { return value; }
+    static uint8_t from_key(Key key) { return key; }
+    static bool less(Key a, Key b) { return a < b; }
+};
+
+template <>
+struct ElementTraits<int32_t> {
+    typedef uint32_t Key;
+    static Key to_key(int32_t value) { return static_cast<uint32_t>(value) ^ 0x80000000u; }
+    static int32_t from_key(Key key) { return static_cast<int32_t>(key ^ 0x80000000u); }
+    static bool less(Key a, Key b) { return a < b; }
+};
+
+template <>
+struct ElementTraits<int64_t> {
+    typedef uint64_t Key;
+    static Key to_key(int64_t value) { return static_cast<uint64_t>(value) ^ 0x8000000000000000ull; }
+    static int64_t from_key(Key key) { return static_cast<int64_t>(key ^ 0x8000000000000000ull); }
+    static bool less(Key a, Key b) { return a < b; }
+};
+
+// Negative floats have every bit flipped, which reverses their order;
+// positive ones only gain the sign bit, which puts them above all
+// negatives.
+template <>
+struct ElementTraits<float> {
+    typedef uint32_t Key;
+    static Key to_key(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+    }
+    static float from_key(Key key)
+    {
+        uint32_t bits = key & 0x80000000u ? key & ~0x80000000u : ~key;
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    static bool less(Key a, Key b) { return a < b; }
+};
+
+template <>
+struct ElementTraits<double> {
+    typedef uint64_t Key;
+    static Key to_key(double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits & 0x8000000000000000ull ? ~bits : bits | 0x8000000000000000ull;
+    }
+    static double from_key(Key key)
+    {
+        uint64_t bits = key & 0x8000000000000000ull ? key & ~0x8000000000000000ull : ~key;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    static bool less(Key a, Key b) { return a < b; }
+};
+
+// N is a constant, so the compiler expands the memcmp inline.
+template <size_t N>
+struct ElementTraits<FixedString<N>> {
+    typedef FixedString<N> Key;
+    static Key to_key(const FixedString<N>& value) { return value; }
+    static FixedString<N> from_key(const Key& key) { return key; }
+    static bool less(const Key& a, const Key& b) { return std::memcmp(a.bytes, b.bytes, N) < 0; }
+};
+
+// In place Fisher-Yates shuffle, no allocation.
+template <typename Key, typename Rng>
+inline void shuffle_elements(Key* keys, size_t length, Rng& rng)
+{
+    for (size_t i = length; i > 1; --i) {
+        std::swap(keys[i - 1], keys[rng.below(static_cast<uint32_t>(i))]);
+    }
+}
+
+// The order a type sorts by unless a search is given another comparator.
+template <typename Traits>
+struct KeyLess {
+    bool operator()(const typename Traits::Key& a, const typename Traits::Key& b) const { return Traits::less(a, b); }
+};
+
+// Ascending and descending checks under less fused into one pass that stops
+// as soon as both directions have failed.
+template <typename Key, typename Less>
+inline bool keys_sorted(const Key* keys, size_t length, const Less& less)
+{
+    bool ascending = true;
+    bool descending = true;
+
+    for (size_t i = 1; i < length; ++i) {
+        ascending = ascending && !less(keys[i], keys[i - 1]);
+        descending = descending && !less(keys[i - 1], keys[i]);
+        if (!ascending && !descending)
+            return false;
+    }
+
+    return true;
+}
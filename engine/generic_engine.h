@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "../bogo.h"
+#include "elements.h"
+#include "rng.h"
+#include "search_engine.h"
+
+// Bogosorts a vector of any ElementTraits type with the shuffle search:
+// worker threads shuffle their own copy of the keys until one comes out
+// sorted in either direction under Less, which defaults to the type's
+// order. The threads, sampling, thread count changes and stopping are a
+// SearchEngine's, run with this engine's worker instead of the digit one,
+// so stats() reads like any search's. There are no modes, checkpoints or
+// UI; the digit search keeps those.
+template <typename T, typename Less = KeyLess<ElementTraits<T>>>
+class GenericEngine
+{
+public:
+    typedef ElementTraits<T> Traits;
+    typedef typename Traits::Key Key;
+    typedef std::function<void(GenericEngine&)> Callback;
+
+    explicit GenericEngine(const std::vector<T>& input, const Less& less = Less())
+        : m_less(less), m_slot_keys(MAX_THREADS),
+        m_engine(std::string(), [this](Search* search, int slot) { worker(*search, slot); })
+    {
+        for (const T& value : input) {
+            m_keys.push_back(Traits::to_key(value));
+        }
+    }
+
+    // Makes every worker's stream reproducible. The winner is still
+    // whichever worker finds a sorted order first. Call before start().
+    void set_seed(uint64_t master) { m_engine.search().seed = master; }
+    void set_rng(RngPolicy rng) { m_engine.search().control.rng.store(static_cast<int>(rng)); }
+
+    // Starts threads workers. on_finished runs on the engine's logic thread
+    // once every worker has exited.
+    void start(int threads, Callback on_finished = Callback())
+    {
+        m_engine.start(std::max(1, std::min(threads, MAX_THREADS)), [this, on_finished](Search&) {
+            if (on_finished)
+                on_finished(*this);
+        });
+    }
+
+    void stop() { m_engine.stop(); }
+    void join() { m_engine.join(); }
+
+    SearchStats& stats() { return m_engine.search().stats; }
+
+    // The winner's sorted elements, empty until stats().success is set.
+    std::vector<T> result()
+    {
+        std::lock_guard<std::mutex> lock(m_result_mutex);
+        std::vector<T> values;
+        for (const Key& key : m_result) {
+            values.push_back(Traits::from_key(key));
+        }
+        return values;
+    }
+
+private:
+    static const int BATCH_ITERATIONS = 1024;
+
+    template <typename Rng>
+    bool run_batch(SearchStats& stats, Key* keys, size_t length, uint64_t& count, ThreadCounter& counter, Rng& rng)
+    {
+        for (int i = 0; i < BATCH_ITERATIONS; ++i) {
+            shuffle_elements(keys, length, rng);
+            counter.iterations.store(++count, std::memory_order_relaxed);
+            if (count == 1)
+                stats.mark(stats.first_iteration_us);
+            if (keys_sorted(keys, length, m_less))
+                return true;
+        }
+        return false;
+    }
+
+    // Like the digit workers, a slot keeps its keys and RNG stream across
+    // thread count changes, so a restarted worker carries on where it
+    // stopped instead of repeating its shuffles.
+    void worker(Search& search, int slot)
+    {
+        SearchStats& stats = search.stats;
+        SearchControl& control = search.control;
+        ThreadCounter& counter = stats.threads[slot];
+        std::vector<Key>& keys = m_slot_keys[slot];
+        if (keys.size() != m_keys.size())
+            keys = m_keys;
+        uint64_t count = counter.iterations.load(std::memory_order_relaxed);
+
+        WorkerSnapshot& snapshot = search.workers[slot];
+        ThreadRng rng;
+        {
+            std::lock_guard<std::mutex> lock(snapshot.mutex);
+            if (snapshot.saved) {
+                rng = snapshot.rng;
+                rng.reseed_crand();
+            }
+            else
+                rng.seed_stream(search.seed, slot);
+        }
+
+        while (!stats.stopped.load() && slot < control.active_threads.load(std::memory_order_relaxed)) {
+            RngPolicy policy = static_cast<RngPolicy>(control.rng.load(std::memory_order_relaxed));
+            bool found = with_rng(policy, rng, [&](auto& r) { return run_batch(stats, keys.data(), keys.size(), count, counter, r); });
+
+            if (found) {
+                int none = -1;
+                if (stats.winner.compare_exchange_strong(none, slot)) {
+                    stats.winner_iterations.store(count);
+                    std::lock_guard<std::mutex> lock(m_result_mutex);
+                    m_result = keys;
+                    stats.success.store(true);
+                }
+                stop();
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(snapshot.mutex);
+        snapshot.iterations = count;
+        snapshot.rng = rng;
+        snapshot.saved = true;
+    }
+
+    Less m_less;
+    std::vector<Key> m_keys;
+    std::vector<std::vector<Key>> m_slot_keys;
+    std::mutex m_result_mutex;
+    std::vector<Key> m_result;
+
+    // Last, so its threads are joined before anything they touch goes away.
+    SearchEngine m_engine;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// One step of Heap's algorithm over m items: every arrangement follows the
+// previous one by a single swap, of positions x and y, which the caller
+// makes. Start with counters all zero and i = 1; the starting order counts
+// as the first arrangement. Returns false after the last of the m! orders.
+inline bool heap_next(size_t m, uint32_t* counters, size_t& i, size_t& x, size_t& y)
+{
+    while (i < m) {
+        if (counters[i] < i) {
+            x = i % 2 == 0 ? 0 : counters[i];
+            y = i;
+            counters[i]++;
+            i = 1;
+            return true;
+        }
+        counters[i] = 0;
+        ++i;
+    }
+    return false;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Inversion count of a digit string under swaps, for annealing. One Fenwick
+// tree per digit value records which positions hold that digit, so the
+// digits strictly between two positions can be counted by value in
+// O(log n). That is all a swap's effect depends on: pairs with a digit
+// outside the two positions keep the same digits on each side.
+//
+// Pairs of unequal digits are either inverted for ascending order or for
+// descending order, and their number never changes, so one count serves
+// both directions.
+class InversionTracker
+{
+public:
+    void reset(const char* a, size_t length)
+    {
+        m_length = length;
+        for (std::vector<int32_t>& tree : m_trees) {
+            tree.assign(length + 1, 0);
+        }
+
+        uint64_t seen[10] = { 0 };
+        m_ascending = 0;
+        m_unequal = 0;
+        for (size_t i = 0; i < length; ++i) {
+            int digit = a[i] - '0';
+            for (int d = 0; d < 10; ++d) {
+                m_ascending += d > digit ? seen[d] : 0;
+                m_unequal += d != digit ? seen[d] : 0;
+            }
+            seen[digit]++;
+            add(digit, i, 1);
+        }
+    }
+
+    // Change in the ascending inversion count if a[x] and a[y] were
+    // swapped. With p < q, low = a[p] < high = a[q], the pair itself and
+    // every digit c between them that lies in [low, high] gain inversions:
+    // one per end of the range c matches, two when it is strictly inside.
+    int64_t swap_delta(const char* a, size_t x, size_t y) const
+    {
+        size_t p = std::min(x, y);
+        size_t q = std::max(x, y);
+        int first = a[p] - '0';
+        int second = a[q] - '0';
+        if (first == second || q == p + 1)
+            return first == second ? 0 : (first < second ? 1 : -1);
+
+        int low = std::min(first, second);
+        int high = std::max(first, second);
+        int64_t delta = 1 + between(low, p, q) + between(high, p, q);
+        for (int d = low + 1; d < high; ++d) {
+            delta += 2 * between(d, p, q);
+        }
+        return first < second ? delta : -delta;
+    }
+
+    // Swaps a[x] and a[y]; delta is swap_delta for the same pair.
+    void swap(char* a, size_t x, size_t y, int64_t delta)
+    {
+        int first = a[x] - '0';
+        int second = a[y] - '0';
+        if (first != second) {
+            add(first, x, -1);
+            add(first, y, 1);
+            add(second, y, -1);
+            add(second, x, 1);
+            std::swap(a[x], a[y]);
+        }
+        m_ascending += delta;
+    }
+
+    uint64_t ascending() const { return m_ascending; }
+    uint64_t descending() const { return m_unequal - m_ascending; }
+
+    // Inversions left for the closer of the two orders; 0 once sorted.
+    uint64_t remaining() const { return std::min(ascending(), descending()); }
+
+    // remaining() as it would be after a swap with the given delta.
+    uint64_t remaining_after(int64_t delta) const
+    {
+        uint64_t ascending = m_ascending + delta;
+        return std::min(ascending, m_unequal - ascending);
+    }
+
+private:
+    void add(int digit, size_t position, int32_t value)
+    {
+        for (size_t i = position + 1; i <= m_length; i += i & (0 - i)) {
+            m_trees[digit][i] += value;
+        }
+    }
+
+    // Positions in [0, end) holding digit.
+    int64_t prefix(int digit, size_t end) const
+    {
+        int64_t total = 0;
+        for (size_t i = end; i > 0; i -= i & (0 - i)) {
+            total += m_trees[digit][i];
+        }
+        return total;
+    }
+
+    // Positions strictly between p and q holding digit.
+    int64_t between(int digit, size_t p, size_t q) const
+    {
+        return prefix(digit, q) - prefix(digit, p + 1);
+    }
+
+    size_t m_length = 0;
+    std::vector<int32_t> m_trees[10];
+    uint64_t m_ascending = 0;
+    uint64_t m_unequal = 0;
+};
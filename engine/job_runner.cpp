@@ -0,0 +1,215 @@
+#include "job_runner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+#include "kernels.h"
+#include "odds.h"
+#include "rng.h"
+
+namespace {
+
+const int JOB_BATCH = 1024;
+
+// Each pool thread seeds its generator on its first job and keeps it.
+Xoshiro256& thread_rng()
+{
+    thread_local Xoshiro256 rng;
+    thread_local bool seeded = false;
+    if (!seeded) {
+        rng.seed(std::random_device()() ^ (static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) << 32));
+        seeded = true;
+    }
+    return rng;
+}
+
+}
+
+JobRunner::JobRunner(int threads, const std::atomic<bool>& stop)
+    : m_stop(stop), m_closing(false), m_next_id(0), m_pool(threads)
+{
+}
+
+JobRunner::~JobRunner()
+{
+    m_closing.store(true);
+    m_pool.wait_idle();
+}
+
+uint64_t JobRunner::submit(const std::string& input, Callback on_finish)
+{
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    job->status.input = input;
+    job->on_finish = on_finish;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job->status.id = m_next_id++;
+        m_jobs[job->status.id] = job;
+    }
+
+    double expected = compute_odds(input.c_str()).expected_attempts;
+    int chunks = 1;
+    uint64_t limit = 0;
+    if (expected > CHUNK_ATTEMPTS) {
+        limit = CHUNK_ATTEMPTS;
+        chunks = static_cast<int>(std::min(static_cast<double>(m_pool.size()), std::ceil(expected / CHUNK_ATTEMPTS)));
+    }
+
+    job->chunks.store(chunks);
+    for (int i = 0; i < chunks; ++i) {
+        m_pool.submit([this, job, limit] { run_chunk(job, limit); });
+    }
+
+    return job->status.id;
+}
+
+bool JobRunner::cancel(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_jobs.find(id);
+    if (it == m_jobs.end())
+        return false;
+
+    it->second->cancelled.store(true);
+    return true;
+}
+
+bool JobRunner::status(uint64_t id, JobStatus& out) const
+{
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(id);
+        if (it == m_jobs.end())
+            return false;
+        job = it->second;
+    }
+
+    fill_status(*job, out);
+    return true;
+}
+
+bool JobRunner::wait(uint64_t id, JobStatus& out)
+{
+    std::shared_ptr<Job> job;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_jobs.find(id);
+        if (it == m_jobs.end())
+            return false;
+        job = it->second;
+        m_finished_cv.wait(lock, [&job] { return job->finished.load(); });
+    }
+
+    fill_status(*job, out);
+    return true;
+}
+
+bool JobRunner::should_stop(const Job& job) const
+{
+    return job.done.load(std::memory_order_relaxed) || job.cancelled.load(std::memory_order_relaxed)
+        || m_stop.load(std::memory_order_relaxed) || m_closing.load(std::memory_order_relaxed);
+}
+
+// Shuffles num until it is sorted, limit attempts have been made (0 means
+// no limit), or the job should stop; the last is checked between batches.
+// Attempts are added to the job's count batch by batch, so status shows
+// progress on a job that runs as one unlimited chunk.
+bool JobRunner::shuffle_until_sorted(Job& job, std::string& num, uint64_t limit)
+{
+    Xoshiro256& rng = thread_rng();
+    size_t length = num.size();
+    uint64_t count = 0;
+    if (digits_sorted(&num[0], length))
+        return true;
+
+    while (!should_stop(job)) {
+        for (int i = 0; i < JOB_BATCH; ++i) {
+            shuffle_digits(&num[0], length, rng);
+            if (digits_sorted(&num[0], length)) {
+                job.iterations += i + 1;
+                return true;
+            }
+        }
+        count += JOB_BATCH;
+        job.iterations += JOB_BATCH;
+
+        if (limit && count >= limit)
+            return false;
+    }
+
+    return false;
+}
+
+// One task of a job. A chunk that runs out of attempts before the job is
+// done pushes itself back onto its worker's deque instead of looping, so
+// other jobs queued there get their turn and idle workers can steal it.
+void JobRunner::run_chunk(std::shared_ptr<Job> job, uint64_t limit)
+{
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (job->status.state == JobState::Queued) {
+            job->status.state = JobState::Running;
+            job->start = std::chrono::steady_clock::now();
+        }
+    }
+
+    std::string num = job->status.input;
+    bool sorted = shuffle_until_sorted(*job, num, limit);
+
+    if (sorted) {
+        bool expected = false;
+        if (job->done.compare_exchange_strong(expected, true)) {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->status.result = num;
+        }
+    }
+    else if (!should_stop(*job)) {
+        m_pool.submit([this, job, limit] { run_chunk(job, limit); });
+        return;
+    }
+
+    if (--job->chunks == 0)
+        finish(*job);
+}
+
+void JobRunner::finish(Job& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(job.mutex);
+        job.status.state = job.done.load() ? JobState::Sorted : JobState::Cancelled;
+        job.status.iterations = job.iterations.load();
+        job.status.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.start).count();
+    }
+
+    if (job.on_finish) {
+        JobStatus status;
+        fill_status(job, status);
+        job.on_finish(status);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job.finished.store(true);
+        m_finished.push_back(job.status.id);
+        if (m_finished.size() > FINISHED_HISTORY) {
+            m_jobs.erase(m_finished.front());
+            m_finished.pop_front();
+        }
+    }
+    m_finished_cv.notify_all();
+}
+
+void JobRunner::fill_status(const Job& job, JobStatus& out) const
+{
+    std::lock_guard<std::mutex> lock(job.mutex);
+    out = job.status;
+    if (out.state == JobState::Running) {
+        out.iterations = job.iterations.load();
+        out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.start).count();
+    }
+}
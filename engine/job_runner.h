@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "worker_pool.h"
+
+enum class JobState { Queued, Running, Sorted, Cancelled };
+
+static const char* const JOB_STATE_NAMES[] = { "queued", "running", "sorted", "cancelled" };
+
+struct JobStatus {
+    uint64_t id = 0;
+    std::string input;
+    JobState state = JobState::Queued;
+    uint64_t iterations = 0;
+    double seconds = 0.0;
+    std::string result;
+};
+
+// Sorts numbers as jobs on a work-stealing WorkerPool. Jobs expected to need
+// more than CHUNK_ATTEMPTS shuffles are split into chunks that re-queue
+// themselves until one of them sorts the number, so idle workers can steal
+// the remaining work of a long job; shorter jobs run as a single task.
+//
+// Finished jobs stay queryable until FINISHED_HISTORY newer ones have
+// finished after them.
+class JobRunner
+{
+public:
+    typedef std::function<void(const JobStatus&)> Callback;
+
+    static const uint64_t CHUNK_ATTEMPTS = 1 << 16;
+    static const size_t FINISHED_HISTORY = 4096;
+
+    // Every job is cancelled once stop is set.
+    JobRunner(int threads, const std::atomic<bool>& stop);
+
+    // Cancels whatever is still running and waits for it.
+    ~JobRunner();
+
+    // on_finish runs on a pool thread once the job is sorted or cancelled.
+    uint64_t submit(const std::string& input, Callback on_finish = Callback());
+
+    // Returns false for an id that is unknown or already forgotten.
+    bool cancel(uint64_t id);
+    bool status(uint64_t id, JobStatus& out) const;
+
+    // Blocks until the job has finished and fills out with its final status.
+    bool wait(uint64_t id, JobStatus& out);
+
+    void wait_idle() { m_pool.wait_idle(); }
+
+    int threads() const { return m_pool.size(); }
+    std::vector<WorkerPool::WorkerStats> worker_stats() const { return m_pool.stats(); }
+
+private:
+    struct Job {
+        JobStatus status;
+        Callback on_finish;
+        std::atomic<bool> done{ false };
+        std::atomic<bool> cancelled{ false };
+        std::atomic<uint64_t> iterations{ 0 };
+        std::atomic<int> chunks{ 0 };
+        std::atomic<bool> finished{ false };
+        std::chrono::steady_clock::time_point start;
+        mutable std::mutex mutex;
+    };
+
+    bool should_stop(const Job& job) const;
+    bool shuffle_until_sorted(Job& job, std::string& num, uint64_t limit);
+    void run_chunk(std::shared_ptr<Job> job, uint64_t limit);
+    void finish(Job& job);
+    void fill_status(const Job& job, JobStatus& out) const;
+
+    const std::atomic<bool>& m_stop;
+    std::atomic<bool> m_closing;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_finished_cv;
+    std::map<uint64_t, std::shared_ptr<Job>> m_jobs;
+    std::deque<uint64_t> m_finished;
+    uint64_t m_next_id;
+
+    // Last, so the threads are joined before anything they touch goes away.
+    WorkerPool m_pool;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "elements.h"
+#include "rng.h"
+
+// Shuffle and sortedness check implementations a worker can run.
+// Legacy is the original randomize_digits / is_sorted pair, kept in
+// search_engine.cpp. Replayable ignores the RNG policy; see replay_attempt.
+enum class Kernel { Legacy, FisherYates, Replayable, Count };
+
+static const char* const KERNEL_NAMES[] = { "Legacy (mpz + random_shuffle)", "Fisher-Yates", "Replayable (Philox, from input)" };
+
+// The digit path is the char instance of the generic element kernels.
+template <typename Rng>
+inline void shuffle_digits(char* digits, size_t length, Rng& rng)
+{
+    shuffle_elements(digits, length, rng);
+}
+
+inline bool digits_sorted(const char* digits, size_t length)
+{
+    return keys_sorted(digits, length, KeyLess<ElementTraits<char>>());
+}
+
+// Identifies one worker's attempts in a replayable search.
+struct ReplayKey {
+    const char* input;
+    uint64_t seed;
+    uint32_t thread;
+};
+
+// Writes the permutation attempt number attempt (counting from 1) of a
+// replayable worker tries: the input shuffled with draws from that
+// attempt's own Philox position. It depends on nothing else, so any attempt
+// of a finished run can be rebuilt in O(length) without re-running it. The
+// shuffle starts from the input instead of the previous attempt, which
+// leaves every attempt just as uniformly random.
+inline void replay_attempt(char* digits, size_t length, const ReplayKey& key, uint64_t attempt)
+{
+    std::memcpy(digits, key.input, length);
+
+    PhiloxStream stream;
+    stream.key(key.seed);
+    stream.seek(key.thread, attempt);
+    shuffle_digits(digits, length, stream);
+}
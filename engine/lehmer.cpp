@@ -0,0 +1,83 @@
+#include "lehmer.h"
+
+#include <algorithm>
+
+RankDispenser::RankDispenser(size_t length) : m_length(length)
+{
+    mpz_init(m_next);
+    mpz_init(m_total);
+    mpz_init(m_scratch);
+    mpz_fac_ui(m_total, static_cast<unsigned long>(length));
+}
+
+RankDispenser::~RankDispenser()
+{
+    mpz_clear(m_next);
+    mpz_clear(m_total);
+    mpz_clear(m_scratch);
+}
+
+bool RankDispenser::claim(int workers, RankRange& range)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_returned.empty()) {
+        range = m_returned.front();
+        m_returned.pop_front();
+        return true;
+    }
+
+    // Guided sizes: a quarter of each worker's share of what is left,
+    // between MIN_RANGE and MAX_RANGE.
+    mpz_sub(m_scratch, m_total, m_next);
+    if (mpz_sgn(m_scratch) == 0)
+        return false;
+
+    uint64_t remaining = mpz_cmp_ui(m_scratch, MAX_RANGE) > 0 ? MAX_RANGE : mpz_get_ui(m_scratch);
+    mpz_fdiv_q_ui(m_scratch, m_scratch, static_cast<unsigned long>(std::max(1, workers) * 4));
+    uint64_t share = mpz_cmp_ui(m_scratch, MAX_RANGE) > 0 ? MAX_RANGE : mpz_get_ui(m_scratch);
+
+    range.count = std::min(remaining, std::max(share, MIN_RANGE));
+    unrank(range.order);
+    mpz_add_ui(m_next, m_next, static_cast<unsigned long>(range.count));
+    return true;
+}
+
+void RankDispenser::give_back(const RankRange& range)
+{
+    if (!range.count)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_returned.push_back(range);
+}
+
+// Digit i of the factorial number system picks which of the positions not
+// used yet goes to slot i.
+void RankDispenser::unrank(std::vector<uint32_t>& order)
+{
+    std::vector<uint32_t> unused(m_length);
+    for (size_t i = 0; i < m_length; ++i) {
+        unused[i] = static_cast<uint32_t>(i);
+    }
+
+    mpz_t rank, place, digit;
+    mpz_init_set(rank, m_next);
+    mpz_init(place);
+    mpz_init(digit);
+    mpz_fac_ui(place, m_length ? static_cast<unsigned long>(m_length - 1) : 0);
+
+    order.resize(m_length);
+    for (size_t i = 0; i < m_length; ++i) {
+        mpz_fdiv_qr(digit, rank, rank, place);
+        size_t pick = mpz_get_ui(digit);
+        order[i] = unused[pick];
+        unused.erase(unused.begin() + pick);
+        if (i + 1 < m_length)
+            mpz_divexact_ui(place, place, static_cast<unsigned long>(m_length - 1 - i));
+    }
+
+    mpz_clear(rank);
+    mpz_clear(place);
+    mpz_clear(digit);
+}
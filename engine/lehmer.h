@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mpir.h>
+#include <mutex>
+#include <vector>
+
+// A run of consecutive permutation ranks: order is the permutation of
+// positions 0..n-1 at the first rank, in lexicographic order, and the rest
+// follow with std::next_permutation.
+struct RankRange {
+    std::vector<uint32_t> order;
+    uint64_t count = 0;
+};
+
+// Hands out disjoint ranges of the n! ranks of a length n permutation to
+// workers. Ranks past 2^64 are fine: the next rank is an MPIR integer, and
+// a range's first permutation is decoded from its rank through the
+// factorial number system (the Lehmer code), once per range.
+//
+// Ranges shrink as the space runs out so workers finish together, and a
+// worker that stops early gives its unfinished range back for the next
+// claim. Either way every rank is handed out exactly once.
+class RankDispenser
+{
+public:
+    explicit RankDispenser(size_t length);
+    ~RankDispenser();
+
+    RankDispenser(const RankDispenser&) = delete;
+    RankDispenser& operator=(const RankDispenser&) = delete;
+
+    // Fills range with the next ranks to try, sized for workers threads.
+    // Returns false once every rank has been handed out.
+    bool claim(int workers, RankRange& range);
+
+    // Returns the untried remainder of a claimed range.
+    void give_back(const RankRange& range);
+
+private:
+    static const uint64_t MIN_RANGE = 1024;
+    static const uint64_t MAX_RANGE = 1 << 16;
+
+    void unrank(std::vector<uint32_t>& order);
+
+    std::mutex m_mutex;
+    size_t m_length;
+    mpz_t m_next;
+    mpz_t m_total;
+    mpz_t m_scratch;
+    std::deque<RankRange> m_returned;
+};
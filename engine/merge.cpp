@@ -0,0 +1,86 @@
+#include "merge.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+
+// Where the first rank outputs end in each run.
+std::vector<size_t> split_runs(const std::string& in, const std::vector<size_t>& bounds, size_t rank)
+{
+    size_t runs = bounds.size() - 1;
+    std::vector<size_t> split(runs);
+    if (rank >= in.size()) {
+        for (size_t j = 0; j < runs; ++j) {
+            split[j] = bounds[j + 1];
+        }
+        return split;
+    }
+
+    // Find the value v whose copies straddle rank.
+    size_t below = 0;
+    char v = '0';
+    for (; v <= '9'; ++v) {
+        size_t equal = 0;
+        for (size_t j = 0; j < runs; ++j) {
+            auto first = in.begin() + bounds[j];
+            auto last = in.begin() + bounds[j + 1];
+            equal += std::upper_bound(first, last, v) - std::lower_bound(first, last, v);
+        }
+        if (below + equal > rank)
+            break;
+        below += equal;
+    }
+
+    size_t copies = rank - below;
+    for (size_t j = 0; j < runs; ++j) {
+        auto first = in.begin() + bounds[j];
+        auto last = in.begin() + bounds[j + 1];
+        size_t lower = std::lower_bound(first, last, v) - in.begin();
+        size_t take = std::min(copies, static_cast<size_t>(std::upper_bound(first, last, v) - in.begin()) - lower);
+        split[j] = lower + take;
+        copies -= take;
+    }
+    return split;
+}
+
+void merge_part(const std::string& in, const std::vector<size_t>& from, const std::vector<size_t>& to, char* out)
+{
+    typedef std::pair<char, size_t> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    std::vector<size_t> next = from;
+    for (size_t j = 0; j < from.size(); ++j) {
+        if (next[j] < to[j])
+            heads.push(Head(in[next[j]], j));
+    }
+
+    while (!heads.empty()) {
+        size_t j = heads.top().second;
+        *out++ = heads.top().first;
+        heads.pop();
+        if (++next[j] < to[j])
+            heads.push(Head(in[next[j]], j));
+    }
+}
+
+}
+
+void parallel_merge(const std::string& in, const std::vector<size_t>& bounds, std::string& out, WorkerPool& pool, int parts)
+{
+    size_t length = in.size();
+    out.resize(length);
+    parts = std::max(1, parts);
+
+    std::vector<std::vector<size_t>> splits(parts + 1);
+    for (int p = 0; p <= parts; ++p) {
+        splits[p] = split_runs(in, bounds, length * p / parts);
+    }
+
+    for (int p = 0; p < parts; ++p) {
+        char* target = &out[0] + length * p / parts;
+        pool.submit([&in, &splits, p, target] { merge_part(in, splits[p], splits[p + 1], target); });
+    }
+    pool.wait_idle();
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "worker_pool.h"
+
+// Merges the ascending runs in[bounds[i], bounds[i + 1]) into out, split
+// into parts output ranges merged as separate tasks on pool. Each range's
+// start in every run is found directly: the first r outputs are the
+// digits below some value v plus the first few copies of v, taken from the
+// runs in order. Each task then merges its slices of all k runs with a
+// heap, so the work is O(n log k / parts) per task.
+void parallel_merge(const std::string& in, const std::vector<size_t>& bounds, std::string& out, WorkerPool& pool, int parts);
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+// How a search walks the permutation space. Shuffle is the original random
+// search and follows the kernel and RNG policy; Bozo, Anneal and Frozen
+// follow the RNG policy only, and the enumerations and Hybrid ignore both.
+// Unlike the kernel, the mode is fixed for the life of a search.
+//   Lehmer: workers enumerate disjoint ranges of permutation ranks, so
+//           none is tried twice and the search ends within n! attempts.
+//   Multiset: workers walk only the distinct arrangements of the digits,
+//           n! / prod(ci!) of them, split between workers by prefix.
+//   Heap:   workers run Heap's algorithm over the suffix after each prefix,
+//           one swap per attempt, tracking sortedness in O(1).
+//   Bozo:   bozosort; each attempt swaps two random digits and is tested
+//           in O(1) whatever the length.
+//   Anneal: "guided bogo"; random swaps are kept or undone by a simulated
+//           annealing rule on the inversion count, evaluated in O(log n).
+//   Frozen: "smart bogo"; digits that land where the sorted number has
+//           them are locked and later attempts shuffle only the rest.
+//   Hybrid: divide and conquer; chunks of a few digits are bogosorted in
+//           parallel on a worker pool, then merged with a k-way merge.
+enum class Mode { Shuffle, Lehmer, Multiset, Heap, Bozo, Anneal, Frozen, Hybrid, Count };
+
+static const char* const MODE_NAMES[] = { "shuffle", "lehmer", "multiset", "heap", "bozo", "anneal", "frozen", "hybrid" };
+
+// Modes that walk a fixed order and never try an arrangement twice.
+inline bool mode_enumerates(Mode mode)
+{
+    return mode == Mode::Lehmer || mode == Mode::Multiset || mode == Mode::Heap;
+}
+
+inline bool parse_mode(const std::string& name, Mode& mode)
+{
+    for (int i = 0; i < static_cast<int>(Mode::Count); ++i) {
+        if (name == MODE_NAMES[i]) {
+            mode = static_cast<Mode>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,63 @@
+#include "multiset.h"
+
+#include <algorithm>
+#include <functional>
+
+PrefixDispenser::PrefixDispenser(const std::string& input) : m_input(input), m_length(0), m_next(0)
+{
+    m_prefixes.push_back(std::string());
+
+    // Grow every prefix by each digit it has left until there are enough,
+    // always leaving at least two digits to walk.
+    while (m_prefixes.size() < TARGET_PREFIXES && m_length + 2 < input.size()) {
+        std::vector<std::string> longer;
+        for (const std::string& prefix : m_prefixes) {
+            int left[10] = { 0 };
+            for (char c : input) {
+                left[c - '0']++;
+            }
+            for (char c : prefix) {
+                left[c - '0']--;
+            }
+            for (int d = 0; d < 10; ++d) {
+                if (left[d] > 0)
+                    longer.push_back(prefix + static_cast<char>('0' + d));
+            }
+        }
+        m_prefixes.swap(longer);
+        m_length++;
+    }
+}
+
+bool PrefixDispenser::claim(PrefixTask& task)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_returned.empty()) {
+        task = m_returned.front();
+        m_returned.pop_front();
+        return true;
+    }
+
+    if (m_next == m_prefixes.size())
+        return false;
+
+    const std::string& prefix = m_prefixes[m_next++];
+    std::string rest = m_input;
+    for (char c : prefix) {
+        rest.erase(rest.find(c), 1);
+    }
+    std::sort(rest.begin(), rest.end(), std::greater<char>());
+
+    task.digits = prefix + rest;
+    task.prefix = m_length;
+    task.i = rest.size() >= 2 ? rest.size() - 2 : 0;
+    task.counters.clear();
+    return true;
+}
+
+void PrefixDispenser::give_back(const PrefixTask& task)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_returned.push_back(task);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Steps a[0..m) to the next distinct arrangement of its digits by moving
+// one digit to the front (Williams' cool-lex order for multisets), with i
+// carrying the position the walk needs. Start from the digits in
+// non-increasing order with i = m - 2; every distinct arrangement is then
+// visited exactly once. Returns false after the last one.
+inline bool multiset_next(char* a, size_t m, size_t& i)
+{
+    if (m < 2 || !(i + 2 < m || a[i + 1] < a[0]))
+        return false;
+
+    size_t k = i + 2 < m && a[i] >= a[i + 2] ? i + 2 : i + 1;
+    char moved = a[k];
+    std::memmove(a + 1, a, k);
+    a[0] = moved;
+    i = moved < a[1] ? 0 : i + 1;
+    return true;
+}
+
+// One worker's share of an enumeration: digits[0..prefix) stay put and
+// digits[prefix..) is walked from state i, plus counters for Heap's
+// algorithm (empty until a Heap walk starts). The arrangement in digits
+// has not been tried yet.
+struct PrefixTask {
+    std::string digits;
+    size_t prefix = 0;
+    size_t i = 0;
+    std::vector<uint32_t> counters;
+};
+
+// Splits the arrangements of a number between workers by fixing the
+// shortest prefix length that yields at least TARGET_PREFIXES distinct
+// prefixes, then hands those prefixes out one at a time. A worker that stops
+// early gives its task back with the walk's state, to be resumed by the
+// next claim, so each arrangement is still tried once. Claimed suffixes
+// come in non-increasing order, ready for multiset_next.
+class PrefixDispenser
+{
+public:
+    explicit PrefixDispenser(const std::string& input);
+
+    PrefixDispenser(const PrefixDispenser&) = delete;
+    PrefixDispenser& operator=(const PrefixDispenser&) = delete;
+
+    // Returns false once every prefix has been handed out.
+    bool claim(PrefixTask& task);
+    void give_back(const PrefixTask& task);
+
+    size_t prefix_length() const { return m_length; }
+    size_t prefix_count() const { return m_prefixes.size(); }
+
+private:
+    static const size_t TARGET_PREFIXES = 1024;
+
+    std::mutex m_mutex;
+    std::string m_input;
+    size_t m_length;
+    std::vector<std::string> m_prefixes;
+    size_t m_next;
+    std::deque<PrefixTask> m_returned;
+};
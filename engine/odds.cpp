@@ -0,0 +1,115 @@
+#include "odds.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mpir.h>
+
+namespace {
+
+const size_t MAX_EXACT_DIGITS = 24;
+
+// Natural log of a value too large for a double.
+double log_mpz(const mpz_t value)
+{
+    signed long exponent;
+    double mantissa = mpz_get_d_2exp(&exponent, value);
+    return std::log(mantissa) + exponent * std::log(2.0);
+}
+
+std::string format_mpz(const mpz_t value)
+{
+    if (mpz_sizeinbase(value, 10) <= MAX_EXACT_DIGITS) {
+        std::string digits(mpz_sizeinbase(value, 10) + 2, '\0');
+        mpz_get_str(&digits[0], 10, value);
+        return digits.c_str();
+    }
+
+    double log10_value = log_mpz(value) / std::log(10.0);
+    double exponent = std::floor(log10_value);
+    char buffer[48];
+    std::snprintf(buffer, sizeof(buffer), "%.3fe%.0f", std::pow(10.0, log10_value - exponent), exponent);
+    return buffer;
+}
+
+// log(1 - p) without losing a tiny p to rounding, or a p that has
+// underflowed altogether.
+double log_miss(const Odds& odds)
+{
+    return odds.probability > 1e-6 ? std::log1p(-odds.probability) : -std::exp(odds.log_probability);
+}
+
+}
+
+Odds compute_odds(const char* num)
+{
+    size_t length = std::strlen(num);
+    unsigned long counts[10] = { 0 };
+    for (size_t i = 0; i < length; ++i) {
+        counts[(num[i] - '0') % 10]++;
+    }
+
+    int distinct = 0;
+    for (unsigned long count : counts) {
+        distinct += count > 0;
+    }
+
+    mpz_t sorted, arrangements, factorial, divisor;
+    mpz_init_set_ui(sorted, 1);
+    mpz_init(arrangements);
+    mpz_init(factorial);
+    mpz_init(divisor);
+
+    mpz_fac_ui(arrangements, static_cast<unsigned long>(length));
+    for (unsigned long count : counts) {
+        mpz_fac_ui(factorial, count);
+        mpz_mul(sorted, sorted, factorial);
+    }
+
+    Odds odds;
+    odds.permutations = format_mpz(arrangements);
+    odds.repeats = format_mpz(sorted);
+    mpz_divexact(divisor, arrangements, sorted);
+    odds.distinct = format_mpz(divisor);
+
+    // Reduce 2 * prod(ci!) / n! so the ratio reads "1 in k" whenever it can.
+    if (distinct > 1) {
+        mpz_mul_ui(sorted, sorted, 2);
+        mpz_gcd(divisor, sorted, arrangements);
+        mpz_divexact(sorted, sorted, divisor);
+        mpz_divexact(arrangements, arrangements, divisor);
+
+        odds.ratio = format_mpz(sorted) + " in " + format_mpz(arrangements);
+        odds.log_probability = log_mpz(sorted) - log_mpz(arrangements);
+        odds.probability = std::exp(odds.log_probability);
+        odds.expected_attempts = std::exp(-odds.log_probability);
+    }
+
+    mpz_clear(sorted);
+    mpz_clear(arrangements);
+    mpz_clear(factorial);
+    mpz_clear(divisor);
+    return odds;
+}
+
+double success_percentile(const Odds& odds, double attempts)
+{
+    if (odds.probability >= 1.0)
+        return attempts > 0.0 ? 1.0 : 0.0;
+    return -std::expm1(attempts * log_miss(odds));
+}
+
+double attempts_for_percentile(const Odds& odds, double percentile)
+{
+    if (odds.probability >= 1.0)
+        return 1.0;
+    return std::log1p(-percentile) / log_miss(odds);
+}
+
+double seconds_to_percentile(const Odds& odds, double attempts, double rate, double percentile)
+{
+    double remaining = attempts_for_percentile(odds, percentile) - attempts;
+    if (remaining <= 0.0)
+        return 0.0;
+    return rate > 0.0 ? remaining / rate : 1e18;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+// Exact chance that one uniform shuffle of a number's digits comes out
+// sorted in either direction. With digit counts c0..c9 and n digits there
+// are n! / prod(ci!) distinct arrangements, two of them sorted (one when
+// every digit is the same), so p = 2 * prod(ci!) / n!.
+struct Odds {
+    std::string ratio = "1 in 1";   // p as an exact reduced fraction, or rounded once it gets long
+    double probability = 1.0;       // underflows to 0 past ~170 digits; log_probability does not
+    double log_probability = 0.0;
+    double expected_attempts = 1.0; // 1 / p
+
+    // n!, prod(ci!) and their quotient, the number of distinct
+    // arrangements; formatted like ratio.
+    std::string permutations = "1";
+    std::string repeats = "1";
+    std::string distinct = "1";
+};
+
+// Computed with MPIR factorials, so the ratio is exact at any length.
+Odds compute_odds(const char* num);
+
+// Chance that a search has succeeded within attempts shuffles: the
+// geometric CDF 1 - (1 - p)^attempts.
+double success_percentile(const Odds& odds, double attempts);
+
+// Attempts by which a search succeeds with the given chance, the inverse
+// of success_percentile.
+double attempts_for_percentile(const Odds& odds, double percentile);
+
+// Seconds from attempts done until the given percentile at rate attempts
+// per second; 0 once it is passed, a huge value when rate is 0.
+double seconds_to_percentile(const Odds& odds, double attempts, double rate, double percentile);
@@ -0,0 +1,271 @@
+#include "portfolio.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const std::chrono::milliseconds REBALANCE_INTERVAL(1000);
+
+// log n!, log prod(ci!) and how many arrangements count as sorted: two,
+// or one when every digit is the same.
+void log_space(const std::string& input, double& log_permutations, double& log_repeats, double& targets)
+{
+    size_t counts[10] = {};
+    for (char digit : input) {
+        counts[digit - '0']++;
+    }
+
+    log_permutations = std::lgamma(static_cast<double>(input.size()) + 1.0);
+    log_repeats = 0.0;
+    int values = 0;
+    for (size_t count : counts) {
+        log_repeats += std::lgamma(static_cast<double>(count) + 1.0);
+        values += count ? 1 : 0;
+    }
+    targets = values > 1 ? 2.0 : 1.0;
+}
+
+}
+
+Portfolio::Portfolio(const std::string& input, const std::vector<Mode>& modes)
+    : m_input(input), m_threads(0), m_winner(-1), m_finished(false), m_stopping(false), m_wake(false)
+{
+    for (Mode mode : modes) {
+        Strategy strategy;
+        strategy.mode = mode;
+        strategy.engine.reset(new SearchEngine(input));
+        strategy.engine->set_mode(mode);
+        m_strategies.push_back(std::move(strategy));
+    }
+}
+
+Portfolio::~Portfolio()
+{
+    stop();
+    join();
+}
+
+void Portfolio::set_seed(uint64_t master)
+{
+    for (Strategy& strategy : m_strategies) {
+        strategy.engine->set_seed(master);
+    }
+}
+
+void Portfolio::start(int threads, Callback on_rebalance, Callback on_finished)
+{
+    int count = static_cast<int>(m_strategies.size());
+    m_threads = std::max(threads, count);
+    m_start = std::chrono::steady_clock::now();
+
+    // Engines report in the order they finish, so the first to have sorted
+    // the number wins even when another gets there within the same tick.
+    SearchEngine::Callback wake = [this](Search& search) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_strategies.size(); ++i) {
+            if (&m_strategies[i].engine->search() == &search && search.stats.success.load() && m_winner < 0)
+                m_winner = static_cast<int>(i);
+        }
+        m_wake = true;
+        m_cv.notify_all();
+    };
+
+    for (int i = 0; i < count; ++i) {
+        Strategy& strategy = m_strategies[i];
+        strategy.threads = m_threads / count + (i < m_threads % count ? 1 : 0);
+        strategy.eta_seconds = std::numeric_limits<double>::infinity();
+        strategy.engine->start(strategy.threads, wake);
+        strategy.best_left = static_cast<double>(strategy.engine->search().stats.initial_inversions);
+    }
+
+    m_coordinator = std::thread(&Portfolio::run, this, on_rebalance, on_finished);
+}
+
+void Portfolio::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+    m_cv.notify_all();
+}
+
+void Portfolio::join()
+{
+    if (m_coordinator.joinable())
+        m_coordinator.join();
+}
+
+double Portfolio::elapsed_seconds() const
+{
+    std::chrono::steady_clock::time_point end = m_finished ? m_end : std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - m_start).count();
+}
+
+double Portfolio::racing_cost() const
+{
+    double cost = 0.0;
+    for (size_t i = 0; i < m_strategies.size(); ++i) {
+        if (static_cast<int>(i) != m_winner)
+            cost += m_strategies[i].thread_seconds;
+    }
+    return cost;
+}
+
+void Portfolio::run(Callback on_rebalance, Callback on_finished)
+{
+    std::chrono::steady_clock::time_point last = m_start;
+
+    while (true) {
+        bool stopping;
+        bool won;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait_for(lock, REBALANCE_INTERVAL, [this] { return m_stopping || m_wake; });
+            m_wake = false;
+            stopping = m_stopping;
+            won = m_winner >= 0;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        bool running = false;
+        for (Strategy& strategy : m_strategies) {
+            Search& search = strategy.engine->search();
+            strategy.thread_seconds += elapsed * search.control.active_threads.load();
+            running |= !search.stats.finished.load();
+        }
+        if (stopping || won || !running)
+            break;
+
+        for (Strategy& strategy : m_strategies) {
+            measure(strategy);
+        }
+        if (rebalance() && on_rebalance)
+            on_rebalance(*this);
+    }
+
+    for (Strategy& strategy : m_strategies) {
+        strategy.engine->stop();
+    }
+    for (Strategy& strategy : m_strategies) {
+        strategy.engine->join();
+        measure(strategy);
+    }
+
+    m_end = std::chrono::steady_clock::now();
+    m_finished = true;
+
+    if (on_finished)
+        on_finished(*this);
+}
+
+void Portfolio::measure(Strategy& strategy)
+{
+    Search& search = strategy.engine->search();
+    SearchStats& stats = search.stats;
+    double attempts = static_cast<double>(stats.total_iterations.load());
+    double log_permutations, log_repeats, targets;
+    log_space(search.input, log_permutations, log_repeats, targets);
+
+    switch (search.mode) {
+    case Mode::Anneal: {
+        double left = stats.success.load() ? 0.0 : static_cast<double>(stats.inversions_left());
+        strategy.best_left = std::min(strategy.best_left, left);
+        strategy.done = static_cast<double>(stats.initial_inversions) - strategy.best_left;
+        strategy.left = std::max(1.0, strategy.best_left);
+        break;
+    }
+    case Mode::Lehmer:
+    case Mode::Multiset:
+    case Mode::Heap: {
+        // The sorted arrangements sit anywhere in the space, so on average
+        // the first turns up after the untried part split by their count.
+        // Lehmer and Heap walk repeated digits as distinct, which makes
+        // every sorted arrangement appear prod(ci!) times.
+        bool distinct = search.mode == Mode::Multiset;
+        double log_size = distinct ? log_permutations - log_repeats : log_permutations;
+        double log_sorted = std::log(targets) + (distinct ? 0.0 : log_repeats);
+        double untried = std::max(0.0, 1.0 - attempts / std::exp(log_size));
+        strategy.done = attempts;
+        strategy.left = std::max(1.0, std::exp(log_size - log_sorted) * untried);
+        break;
+    }
+    case Mode::Frozen:
+        // About one digit locks per attempt, in every worker at once.
+        strategy.done = attempts;
+        strategy.left = std::max(1.0, static_cast<double>(search.input.size()) - attempts / std::max(1, strategy.threads));
+        break;
+    default:
+        // Shuffle and Bozo forget what they tried, so the expected attempts
+        // left never shrink.
+        strategy.done = attempts;
+        strategy.left = stats.odds.expected_attempts;
+        break;
+    }
+
+    if (stats.success.load())
+        strategy.left = 0.0;
+
+    double speed = strategy.thread_seconds > 0.0 ? strategy.done / strategy.thread_seconds : 0.0;
+    strategy.eta_seconds = speed > 0.0 ? strategy.left / (speed * strategy.threads) : std::numeric_limits<double>::infinity();
+}
+
+// Returns true when any share changed.
+bool Portfolio::rebalance()
+{
+    size_t count = m_strategies.size();
+    std::vector<double> weights(count, 0.0);
+    double total = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const Strategy& strategy = m_strategies[i];
+        double speed = strategy.thread_seconds > 0.0 ? strategy.done / strategy.thread_seconds : 0.0;
+        double weight = speed / strategy.left;
+        if (std::isfinite(weight) && weight > 0.0) {
+            weights[i] = weight;
+            total += weight;
+        }
+    }
+
+    // No strategy still running weighs under half an even split.
+    double least = total / (2.0 * count);
+    for (size_t i = 0; i < count; ++i) {
+        if (weights[i] < least && !m_strategies[i].engine->search().stats.finished.load()) {
+            total += least - weights[i];
+            weights[i] = least;
+        }
+    }
+
+    // One thread each keeps every strategy measured; the rest go by weight,
+    // rounded by largest remainder, or evenly while nothing has progressed.
+    int spare = m_threads - static_cast<int>(count);
+    std::vector<int> shares(count, 1);
+    std::vector<double> remainders(count, 0.0);
+    int given = 0;
+    for (size_t i = 0; i < count; ++i) {
+        double exact = total > 0.0 ? spare * weights[i] / total : static_cast<double>(spare) / count;
+        int whole = static_cast<int>(exact);
+        shares[i] += whole;
+        given += whole;
+        remainders[i] = exact - whole;
+    }
+    while (given < spare) {
+        size_t best = std::max_element(remainders.begin(), remainders.end()) - remainders.begin();
+        shares[best]++;
+        remainders[best] = -1.0;
+        given++;
+    }
+
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        Strategy& strategy = m_strategies[i];
+        if (shares[i] != strategy.threads) {
+            strategy.threads = shares[i];
+            strategy.engine->search().control.requested_threads.store(shares[i]);
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "search_engine.h"
+
+// Races several modes on one number, each in its own SearchEngine on a
+// disjoint share of the threads. The first strategy to sort the number
+// wins and the rest are stopped.
+//
+// Every strategy starts with an even share. Once a second, each one's
+// speed is measured as work done per thread-second, and the threads beyond
+// one per strategy are handed out in proportion to speed / work left, the
+// inverse of the time each would take alone on one thread. Work is counted
+// in attempts, or for Mode::Anneal in inversions removed as of the best
+// state seen, since annealing climbs back up between improvements. A
+// strategy weighed at under half an even split is topped up to that, so one
+// that has not shown progress yet is not starved of the threads to show it.
+// Mode::Hybrid sizes its pool once and cannot race.
+class Portfolio
+{
+public:
+    struct Strategy {
+        Mode mode;
+        std::unique_ptr<SearchEngine> engine;
+        int threads = 0;
+        double thread_seconds = 0.0;
+        double done = 0.0;
+        double left = 0.0;
+        double best_left = 0.0;     // Mode::Anneal: fewest inversions seen so far
+        double eta_seconds = 0.0;   // at its current share; infinite until it makes progress
+    };
+
+    typedef std::function<void(Portfolio&)> Callback;
+
+    Portfolio(const std::string& input, const std::vector<Mode>& modes);
+
+    // Stops the race if it is still running and waits for every engine.
+    ~Portfolio();
+
+    // Seeds every strategy that takes a seed. The shares follow measured
+    // speed, so the race itself is not reproducible. Call before start().
+    void set_seed(uint64_t master);
+
+    // Starts every strategy and the coordinator thread. threads must be at
+    // least the number of strategies. on_rebalance runs on the coordinator
+    // whenever the shares change, on_finished once every engine has exited.
+    void start(int threads, Callback on_rebalance = Callback(), Callback on_finished = Callback());
+
+    void stop();
+    void join();
+
+    const std::string& input() const { return m_input; }
+    std::vector<Strategy>& strategies() { return m_strategies; }
+    int threads() const { return m_threads; }
+
+    // Index of the first strategy to sort the number; valid once
+    // on_finished runs, -1 if the race was stopped.
+    int winner() const { return m_winner; }
+
+    // Seconds since start, or the length of the race once it is over.
+    double elapsed_seconds() const;
+
+    // Thread-seconds spent on the strategies that did not win.
+    double racing_cost() const;
+
+private:
+    void run(Callback on_rebalance, Callback on_finished);
+    void measure(Strategy& strategy);
+    bool rebalance();
+
+    std::string m_input;
+    std::vector<Strategy> m_strategies;
+    int m_threads;
+    int m_winner;
+    bool m_finished;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::time_point m_end;
+
+    // Guards m_winner until the race is over, and the wake flags.
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping;
+    bool m_wake;
+    std::thread m_coordinator;
+};
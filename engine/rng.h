@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <istream>
+#include <ostream>
+#include <random>
+
+// Random number sources a worker can draw shuffle indices from.
+enum class RngPolicy { CRand, Mt19937, Xoshiro256, Count };
+
+static const char* const RNG_POLICY_NAMES[] = { "rand()", "mt19937", "xoshiro256**" };
+
+// Maps a 32 bit random value onto [0, n) with a multiply instead of a modulo.
+inline uint32_t scale_below(uint32_t x, uint32_t n)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(x) * n) >> 32);
+}
+
+inline uint64_t splitmix64(uint64_t& state)
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// The C runtime generator. Its state is per thread on MSVC, so every thread
+// has to seed it or they all walk the same sequence.
+// MSVC's RAND_MAX is 32767, so rand() % n could never reach past 32767 and
+// favoured low indices for any n not dividing 32768. Two 15 bit draws make
+// a 30 bit value instead, scaled like scale_below and redrawn in the rare
+// case that would bias the result, so every n up to 2^30 is exact.
+struct CRandRng
+{
+    void seed(uint64_t s) { srand(static_cast<unsigned>(s)); }
+
+    uint32_t below(uint32_t n)
+    {
+        uint64_t m = static_cast<uint64_t>(wide()) * n;
+        uint32_t low = static_cast<uint32_t>(m) & WIDE_MASK;
+        if (low < n) {
+            uint32_t threshold = (WIDE_MASK + 1 - n) % n;
+            while (low < threshold) {
+                m = static_cast<uint64_t>(wide()) * n;
+                low = static_cast<uint32_t>(m) & WIDE_MASK;
+            }
+        }
+        return static_cast<uint32_t>(m >> 30);
+    }
+
+private:
+    static const uint32_t WIDE_MASK = 0x3fffffff;
+
+    static uint32_t wide() { return (static_cast<uint32_t>(rand() & 0x7fff) << 15) | static_cast<uint32_t>(rand() & 0x7fff); }
+};
+
+struct Mt19937Rng
+{
+    std::mt19937 gen;
+
+    void seed(uint64_t s) { gen.seed(static_cast<uint32_t>(s ^ (s >> 32))); }
+    uint32_t below(uint32_t n) { return scale_below(gen(), n); }
+};
+
+// xoshiro256** by Blackman and Vigna.
+class Xoshiro256
+{
+public:
+    void seed(uint64_t s)
+    {
+        for (int i = 0; i < 4; ++i) {
+            m_s[i] = splitmix64(s);
+        }
+    }
+
+    uint64_t next()
+    {
+        const uint64_t result = rotl(m_s[1] * 5, 7) * 9;
+        const uint64_t t = m_s[1] << 17;
+
+        m_s[2] ^= m_s[0];
+        m_s[3] ^= m_s[1];
+        m_s[1] ^= m_s[2];
+        m_s[0] ^= m_s[3];
+        m_s[2] ^= t;
+        m_s[3] = rotl(m_s[3], 45);
+
+        return result;
+    }
+
+    uint32_t below(uint32_t n) { return scale_below(static_cast<uint32_t>(next() >> 32), n); }
+
+    // Advances the state by 2^128 steps, as if next() had been called that
+    // many times. Streams started from one seed and jumped 0, 1, 2, ...
+    // times can never overlap within 2^128 draws each.
+    void jump()
+    {
+        static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+        uint64_t s[4] = { 0, 0, 0, 0 };
+        for (uint64_t word : JUMP) {
+            for (int bit = 0; bit < 64; ++bit) {
+                if (word & (1ULL << bit)) {
+                    for (int i = 0; i < 4; ++i) {
+                        s[i] ^= m_s[i];
+                    }
+                }
+                next();
+            }
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            m_s[i] = s[i];
+        }
+    }
+
+    // Text form of the state, in the style of std::mt19937's stream operators.
+    friend std::ostream& operator<<(std::ostream& out, const Xoshiro256& rng)
+    {
+        return out << rng.m_s[0] << ' ' << rng.m_s[1] << ' ' << rng.m_s[2] << ' ' << rng.m_s[3];
+    }
+
+    friend std::istream& operator>>(std::istream& in, Xoshiro256& rng)
+    {
+        return in >> rng.m_s[0] >> rng.m_s[1] >> rng.m_s[2] >> rng.m_s[3];
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    uint64_t m_s[4];
+};
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+// 3"). Counter based: every block is a pure function of (counter, key), so
+// any point of any stream can be computed directly instead of stepping to
+// it. The counter holds the block index, a 64 bit position and the stream.
+class PhiloxStream
+{
+public:
+    void key(uint64_t seed)
+    {
+        m_key[0] = static_cast<uint32_t>(seed);
+        m_key[1] = static_cast<uint32_t>(seed >> 32);
+    }
+
+    // Moves to the first draw of position within stream.
+    void seek(uint32_t stream, uint64_t position)
+    {
+        m_counter[0] = 0;
+        m_counter[1] = static_cast<uint32_t>(position);
+        m_counter[2] = static_cast<uint32_t>(position >> 32);
+        m_counter[3] = stream;
+        m_used = 4;
+    }
+
+    uint32_t next()
+    {
+        if (m_used == 4) {
+            block();
+            m_counter[0]++;
+            m_used = 0;
+        }
+        return m_out[m_used++];
+    }
+
+    uint32_t below(uint32_t n) { return scale_below(next(), n); }
+
+private:
+    void block()
+    {
+        uint32_t x[4] = { m_counter[0], m_counter[1], m_counter[2], m_counter[3] };
+        uint32_t k0 = m_key[0];
+        uint32_t k1 = m_key[1];
+
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = static_cast<uint64_t>(0xd2511f53u) * x[0];
+            uint64_t p1 = static_cast<uint64_t>(0xcd9e8d57u) * x[2];
+            uint32_t next[4] = {
+                static_cast<uint32_t>(p1 >> 32) ^ x[1] ^ k0,
+                static_cast<uint32_t>(p1),
+                static_cast<uint32_t>(p0 >> 32) ^ x[3] ^ k1,
+                static_cast<uint32_t>(p0)
+            };
+            for (int i = 0; i < 4; ++i) {
+                x[i] = next[i];
+            }
+            k0 += 0x9e3779b9u;
+            k1 += 0xbb67ae85u;
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            m_out[i] = x[i];
+        }
+    }
+
+    uint32_t m_key[2] = { 0, 0 };
+    uint32_t m_counter[4] = { 0, 0, 0, 0 };
+    uint32_t m_out[4];
+    int m_used = 4;
+};
+
+// Every policy's state for one worker, so switching policy mid-run is free.
+struct ThreadRng
+{
+    CRandRng crand;
+    Mt19937Rng mt;
+    Xoshiro256 xoshiro;
+
+    void seed(uint64_t s)
+    {
+        crand.seed(splitmix64(s));
+        mt.seed(splitmix64(s));
+        xoshiro.seed(splitmix64(s));
+    }
+
+    // Reproducible seeding from one master seed. xoshiro streams are the
+    // master stream jumped stream times, so they are disjoint. mt19937 has
+    // no cheap jump and rand() no state access; both get a seed mixed from
+    // (master, stream), which makes them reproducible but not provably
+    // disjoint.
+    void seed_stream(uint64_t master, int stream)
+    {
+        uint64_t s = master;
+        xoshiro.seed(s);
+        for (int i = 0; i < stream; ++i) {
+            xoshiro.jump();
+        }
+
+        s = master ^ (static_cast<uint64_t>(stream) * 0x9e3779b97f4a7c15ULL);
+        mt.seed(splitmix64(s));
+        crand.seed(splitmix64(s));
+    }
+
+    // Used by checkpoints. mt19937 and xoshiro continue exactly where they
+    // were saved; rand() is left to reseed_crand().
+    void save(std::ostream& out) const
+    {
+        out << mt.gen << ' ' << xoshiro;
+    }
+
+    bool load(std::istream& in)
+    {
+        return static_cast<bool>(in >> mt.gen >> xoshiro);
+    }
+
+    // rand() keeps its state per thread inside the C runtime, where it can't
+    // be read back or copied with the rest. A worker taking over a saved
+    // ThreadRng calls this on its own thread to seed rand() from the xoshiro
+    // state instead, so every worker still draws a different sequence.
+    void reseed_crand()
+    {
+        Xoshiro256 copy = xoshiro;
+        crand.seed(copy.next());
+    }
+};
+
+// Calls f with the policy's generator from rng. f is usually a generic
+// lambda, so each policy gets its own inlined copy of the batch loop.
+template <typename F>
+auto with_rng(RngPolicy policy, ThreadRng& rng, F&& f) -> decltype(f(rng.crand))
+{
+    switch (policy) {
+    case RngPolicy::Mt19937:
+        return f(rng.mt);
+    case RngPolicy::Xoshiro256:
+        return f(rng.xoshiro);
+    default:
+        return f(rng.crand);
+    }
+}
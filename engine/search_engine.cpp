@@ -0,0 +1,869 @@
+#include "search_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mpir.h>
+#include <random>
+#include <vector>
+
+#include "adjacency.h"
+#include "heap.h"
+#include "inversions.h"
+#include "kernels.h"
+#include "lehmer.h"
+#include "merge.h"
+#include "multiset.h"
+#include "odds.h"
+#include "rng.h"
+#include "worker_pool.h"
+
+namespace {
+
+const std::chrono::milliseconds SAMPLE_INTERVAL(100);
+const int BATCH_ITERATIONS = 1024;
+
+// Annealing starts hot enough to take swaps that add a few inversions and
+// halves its temperature every n proposals down to a floor where it only
+// moves sideways or downhill. Downhill moves exist until the number is
+// sorted (any adjacent pair out of order is one), so it never gets stuck.
+const double ANNEAL_START_TEMPERATURE = 4.0;
+const double ANNEAL_MIN_TEMPERATURE = 0.05;
+const uint32_t ACCEPT_RESOLUTION = 32768;
+
+// Hybrid chunks take at most 8! = 40320 shuffles each, well under a
+// millisecond, so the bogo phase costs about n / 8 of those per thread.
+const size_t HYBRID_CHUNK_DIGITS = 8;
+
+bool is_sorted(const char* numStr) {
+    size_t length = std::strlen(numStr);
+
+    mpz_t num;
+    mpz_init(num);
+    mpz_set_str(num, numStr, 10);
+
+    bool ascending = true;
+    for (size_t i = 1; i < length; ++i) {
+        if (numStr[i] < numStr[i - 1]) {
+            ascending = false;
+            break;
+        }
+    }
+
+    bool descending = true;
+    for (size_t i = 1; i < length; ++i) {
+        if (numStr[i] > numStr[i - 1]) {
+            descending = false;
+            break;
+        }
+    }
+
+    bool sorted = ascending || descending;
+    mpz_clear(num);
+
+    return sorted;
+}
+
+template <typename Rng>
+void randomize_digits(char* numStr, Rng& rng) {
+    size_t length = std::strlen(numStr);
+
+    mpz_t num;
+    mpz_init(num);
+    mpz_set_str(num, numStr, 10);
+
+    std::vector<char> digits;
+    for (size_t i = 0; i < length; ++i) {
+        digits.push_back(numStr[i]);
+    }
+
+    std::random_shuffle(digits.begin(), digits.end(), [&rng](ptrdiff_t n) { return rng.below(static_cast<uint32_t>(n)); });
+
+    for (size_t i = 0; i < length; ++i) {
+        numStr[i] = digits[i];
+    }
+
+    mpz_clear(num);
+}
+
+void stop_search(Search& search) {
+    {
+        std::lock_guard<std::mutex> lock(search.mtx);
+        search.stats.stopped.store(true);
+    }
+    search.stopped_cv.notify_all();
+}
+
+// Length of the longest prefix of num in ascending or descending order.
+uint32_t sorted_prefix(const char* num, size_t length) {
+    if (length == 0)
+        return 0;
+
+    size_t ascending = 1;
+    while (ascending < length && num[ascending] >= num[ascending - 1]) {
+        ++ascending;
+    }
+
+    size_t descending = 1;
+    while (descending < length && num[descending] <= num[descending - 1]) {
+        ++descending;
+    }
+
+    return static_cast<uint32_t>(std::max(ascending, descending));
+}
+
+// Adds num to the worker's digit-position histogram and best prefix.
+void record_positions(const char* num, size_t length, ThreadCounter& counter) {
+    size_t positions = std::min(length, static_cast<size_t>(HEATMAP_POSITIONS));
+    for (size_t i = 0; i < positions; ++i) {
+        std::atomic<uint32_t>& cell = counter.digit_positions[i][num[i] - '0'];
+        cell.store(cell.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint32_t prefix = sorted_prefix(num, length);
+    if (prefix > counter.best_prefix.load(std::memory_order_relaxed))
+        counter.best_prefix.store(prefix, std::memory_order_relaxed);
+}
+
+// Copies the worker's state out for the checkpoint writer. Called from the
+// worker itself, between batches, so the state is consistent.
+void save_snapshot(Search* search, WorkerSnapshot& snapshot, const char* num, uint64_t count, const ThreadRng& rng) {
+    uint64_t epoch = search->checkpoint_epoch.load();
+    std::lock_guard<std::mutex> lock(snapshot.mutex);
+    snapshot.iterations = count;
+    snapshot.permutation.assign(num);
+    snapshot.rng = rng;
+    snapshot.saved = true;
+    snapshot.epoch.store(epoch);
+}
+
+// Bookkeeping after every attempt, whatever produced it.
+inline void count_attempt(const char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter) {
+    ++count;
+    counter.iterations.store(count, std::memory_order_relaxed);
+    if ((count & (HEATMAP_STRIDE - 1)) == 0)
+        record_positions(num, length, counter);
+    if (count == 1)
+        stats.mark(stats.first_iteration_us);
+}
+
+// Runs up to BATCH_ITERATIONS attempts with a fixed kernel and RNG. The
+// Replayable kernel draws from replay instead of rng.
+// Returns true when num ends up sorted.
+template <typename Rng>
+bool run_batch(Kernel kernel, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter, Rng& rng, const ReplayKey& replay) {
+    for (int i = 0; i < BATCH_ITERATIONS; ++i) {
+        bool sorted;
+        if (kernel == Kernel::Replayable) {
+            replay_attempt(num, length, replay, count + 1);
+            sorted = digits_sorted(num, length);
+        }
+        else if (kernel == Kernel::FisherYates) {
+            shuffle_digits(num, length, rng);
+            sorted = digits_sorted(num, length);
+        }
+        else {
+            randomize_digits(num, rng);
+            sorted = is_sorted(num);
+        }
+
+        count_attempt(num, length, count, stats, counter);
+
+        if (sorted)
+            return true;
+        if (stats.stopped.load(std::memory_order_relaxed))
+            return false;
+    }
+
+    return false;
+}
+
+// Tries up to BATCH_ITERATIONS ranks of range in order, consuming them.
+// Returns true when num ends up sorted.
+bool run_lehmer_batch(RankRange& range, const std::string& input, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter) {
+    for (int i = 0; i < BATCH_ITERATIONS && range.count; ++i) {
+        for (size_t j = 0; j < length; ++j) {
+            num[j] = input[range.order[j]];
+        }
+        bool sorted = digits_sorted(num, length);
+        std::next_permutation(range.order.begin(), range.order.end());
+        --range.count;
+
+        count_attempt(num, length, count, stats, counter);
+
+        if (sorted)
+            return true;
+        if (stats.stopped.load(std::memory_order_relaxed))
+            return false;
+    }
+
+    return false;
+}
+
+// Tries up to BATCH_ITERATIONS arrangements of task's suffix, walking num
+// in place; has_task drops once the walk is over. Returns true when num
+// ends up sorted.
+bool run_multiset_batch(PrefixTask& task, bool& has_task, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter) {
+    for (int i = 0; i < BATCH_ITERATIONS && has_task; ++i) {
+        bool sorted = digits_sorted(num, length);
+
+        count_attempt(num, length, count, stats, counter);
+
+        if (sorted)
+            return true;
+        has_task = multiset_next(num + task.prefix, length - task.prefix, task.i);
+        if (stats.stopped.load(std::memory_order_relaxed))
+            return false;
+    }
+
+    return false;
+}
+
+// Tries up to BATCH_ITERATIONS orders of task's suffix in Heap's order.
+// tracker follows every swap, so each test is O(1). Returns true when num
+// ends up sorted.
+bool run_heap_batch(PrefixTask& task, AdjacencyTracker& tracker, bool& has_task, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter) {
+    size_t m = length - task.prefix;
+    for (int i = 0; i < BATCH_ITERATIONS && has_task; ++i) {
+        bool sorted = tracker.sorted();
+
+        count_attempt(num, length, count, stats, counter);
+
+        if (sorted)
+            return true;
+        size_t x, y;
+        has_task = heap_next(m, &task.counters[0], task.i, x, y);
+        if (has_task)
+            tracker.swap(num, task.prefix + x, task.prefix + y);
+        if (stats.stopped.load(std::memory_order_relaxed))
+            return false;
+    }
+
+    return false;
+}
+
+// Runs up to BATCH_ITERATIONS bozosort attempts: swap two random digits,
+// possibly the same one, and test in O(1) through tracker. Returns true
+// when num ends up sorted.
+template <typename Rng>
+bool run_bozo_batch(AdjacencyTracker& tracker, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter, Rng& rng) {
+    uint32_t n = static_cast<uint32_t>(length);
+    for (int i = 0; i < BATCH_ITERATIONS; ++i) {
+        uint32_t x = rng.below(n);
+        uint32_t y = rng.below(n);
+        tracker.swap(num, x, y);
+
+        count_attempt(num, length, count, stats, counter);
+
+        if (tracker.sorted())
+            return true;
+        if (stats.stopped.load(std::memory_order_relaxed))
+            return false;
+    }
+
+    return false;
+}
+
+struct AnnealState {
+    InversionTracker inversions;
+    double temperature;
+    double cooling;
+};
+
+// Runs up to BATCH_ITERATIONS annealing proposals: a random swap, kept if
+// it leaves no more inversions than before, or else with probability
+// exp(-increase / temperature). Returns true when num ends up sorted.
+template <typename Rng>
+bool run_anneal_batch(AnnealState& state, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter, Rng& rng) {
+    uint32_t n = static_cast<uint32_t>(length);
+    bool sorted = false;
+    for (int i = 0; i < BATCH_ITERATIONS && !sorted; ++i) {
+        uint32_t x = rng.below(n);
+        uint32_t y = rng.below(n);
+        int64_t delta = state.inversions.swap_delta(num, x, y);
+        uint64_t before = state.inversions.remaining();
+        uint64_t after = state.inversions.remaining_after(delta);
+        if (after <= before || rng.below(ACCEPT_RESOLUTION) < ACCEPT_RESOLUTION * std::exp((static_cast<double>(before) - after) / state.temperature))
+            state.inversions.swap(num, x, y, delta);
+        state.temperature = std::max(ANNEAL_MIN_TEMPERATURE, state.temperature * state.cooling);
+
+        count_attempt(num, length, count, stats, counter);
+
+        sorted = state.inversions.remaining() == 0;
+        if (stats.stopped.load(std::memory_order_relaxed))
+            break;
+    }
+
+    counter.inversions.store(state.inversions.remaining(), std::memory_order_relaxed);
+    return sorted;
+}
+
+// A frozen worker aims for one direction, ascending on even threads and
+// descending on odd ones, so with two or more workers both are covered.
+// free holds the positions that do not have their target digit yet.
+struct FrozenState {
+    std::string target;
+    std::vector<uint32_t> free;
+};
+
+void init_frozen(FrozenState& state, const std::string& input, const char* num, bool descending) {
+    state.target = input;
+    std::sort(state.target.begin(), state.target.end());
+    if (descending)
+        std::reverse(state.target.begin(), state.target.end());
+
+    state.free.clear();
+    for (uint32_t i = 0; i < state.target.size(); ++i) {
+        if (num[i] != state.target[i])
+            state.free.push_back(i);
+    }
+}
+
+// Runs up to BATCH_ITERATIONS attempts, each a Fisher-Yates shuffle of the
+// free positions only, after which any of them that now hold their target
+// digit are locked for good. Each attempt locks about one digit on average,
+// so the expected attempts grow roughly linearly with the length instead of
+// factorially. Returns true when no free position is left.
+template <typename Rng>
+bool run_frozen_batch(FrozenState& state, char* num, size_t length, uint64_t& count, SearchStats& stats, ThreadCounter& counter, Rng& rng) {
+    for (int i = 0; i < BATCH_ITERATIONS && !state.free.empty(); ++i) {
+        std::vector<uint32_t>& free = state.free;
+        for (size_t k = free.size() - 1; k > 0; --k) {
+            std::swap(num[free[k]], num[free[rng.below(static_cast<uint32_t>(k + 1))]]);
+        }
+
+        size_t kept = 0;
+        for (uint32_t position : free) {
+            if (num[position] != state.target[position])
+                free[kept++] = position;
+        }
+        free.resize(kept);
+
+        count_attempt(num, length, count, stats, counter);
+
+        if (stats.stopped.load(std::memory_order_relaxed))
+            break;
+    }
+
+    return state.free.empty();
+}
+
+void bogosort_thread(Search* search, int threadId) {
+    SearchStats& stats = search->stats;
+    SearchControl& control = search->control;
+    char* num = &search->thread_numbers[threadId][0];
+    size_t length = std::strlen(num);
+    ThreadCounter& counter = stats.threads[threadId];
+    uint64_t count = counter.iterations.load(std::memory_order_relaxed);
+
+    WorkerSnapshot& snapshot = search->workers[threadId];
+    ReplayKey replay = { search->input.c_str(), search->seed, static_cast<uint32_t>(threadId) };
+    RankRange range;
+    PrefixTask task;
+    bool has_task = false;
+    AdjacencyTracker tracker;
+    if (search->mode == Mode::Bozo)
+        tracker.reset(num, length);
+    FrozenState frozen;
+    if (search->mode == Mode::Frozen)
+        init_frozen(frozen, search->input, num, threadId % 2 == 1);
+    AnnealState anneal;
+    if (search->mode == Mode::Anneal) {
+        anneal.inversions.reset(num, length);
+        anneal.temperature = ANNEAL_START_TEMPERATURE;
+        anneal.cooling = std::pow(0.5, 1.0 / static_cast<double>(length));
+    }
+
+    // A slot that has run before, in this search or in the checkpoint it
+    // resumed, carries on from its saved stream: a worker restarted after
+    // the thread count dropped and rose again would otherwise replay
+    // shuffles it already tried. rand() alone can't continue, see
+    // reseed_crand().
+    ThreadRng rng;
+    {
+        std::lock_guard<std::mutex> lock(snapshot.mutex);
+        if (snapshot.saved) {
+            rng = snapshot.rng;
+            rng.reseed_crand();
+        }
+        else
+            rng.seed_stream(search->seed, threadId);
+    }
+
+    // A deterministic worker keeps going until it has made as many attempts
+    // as the best find so far; past that nothing it finds can win.
+    while (!stats.stopped.load() && threadId < control.active_threads.load(std::memory_order_relaxed)
+        && !(search->deterministic && count >= stats.best_key.load(std::memory_order_relaxed) / MAX_THREADS)) {
+        Kernel kernel = static_cast<Kernel>(control.kernel.load(std::memory_order_relaxed));
+        RngPolicy policy = static_cast<RngPolicy>(control.rng.load(std::memory_order_relaxed));
+
+        bool found;
+        if (search->mode == Mode::Lehmer) {
+            if (!range.count && !search->ranks->claim(control.active_threads.load(std::memory_order_relaxed), range))
+                break;
+            found = run_lehmer_batch(range, search->input, num, length, count, stats, counter);
+        }
+        else if (search->mode == Mode::Multiset || search->mode == Mode::Heap) {
+            bool heap = search->mode == Mode::Heap;
+            if (!has_task) {
+                if (!search->prefixes->claim(task))
+                    break;
+                std::memcpy(num, task.digits.data(), length);
+                if (heap && task.counters.empty()) {
+                    task.counters.assign(length - task.prefix, 0);
+                    task.i = 1;
+                }
+                if (heap)
+                    tracker.reset(num, length);
+                has_task = true;
+            }
+            found = heap ? run_heap_batch(task, tracker, has_task, num, length, count, stats, counter)
+                : run_multiset_batch(task, has_task, num, length, count, stats, counter);
+        }
+        else if (search->mode == Mode::Bozo) {
+            found = with_rng(policy, rng, [&](auto& r) { return run_bozo_batch(tracker, num, length, count, stats, counter, r); });
+        }
+        else if (search->mode == Mode::Anneal) {
+            found = with_rng(policy, rng, [&](auto& r) { return run_anneal_batch(anneal, num, length, count, stats, counter, r); });
+        }
+        else if (search->mode == Mode::Frozen) {
+            found = with_rng(policy, rng, [&](auto& r) { return run_frozen_batch(frozen, num, length, count, stats, counter, r); });
+        }
+        else {
+            found = with_rng(policy, rng, [&](auto& r) { return run_batch(kernel, num, length, count, stats, counter, r, replay); });
+        }
+
+        if (found && search->deterministic) {
+            uint64_t key = count * MAX_THREADS + threadId;
+            std::lock_guard<std::mutex> lock(stats.snapshot_mutex);
+            if (key < stats.best_key.load()) {
+                stats.best_key.store(key);
+                stats.best_number.assign(num);
+            }
+        }
+        else if (found) {
+            int none = -1;
+            if (stats.winner.compare_exchange_strong(none, threadId)) {
+                stats.winner_iterations.store(count);
+                stats.publish(num, true);
+            }
+            stop_search(*search);
+        }
+        else {
+            stats.publish(num, false);
+        }
+
+        if (search->checkpoint_epoch.load(std::memory_order_relaxed) != snapshot.epoch.load(std::memory_order_relaxed))
+            save_snapshot(search, snapshot, num, count, rng);
+    }
+
+    // Work this worker claimed but never tried goes to whoever claims next.
+    if (search->ranks && !stats.success.load())
+        search->ranks->give_back(range);
+    if (has_task && !stats.success.load()) {
+        task.digits.assign(num, length);
+        search->prefixes->give_back(task);
+    }
+
+    save_snapshot(search, snapshot, num, count, rng);
+}
+
+// Bogosorts one hybrid chunk in place. Chunks only count as sorted in
+// ascending order, so they can be merged. Each chunk shuffles from its own
+// Philox stream, so a seeded search sorts every chunk the same way however
+// the pool schedules them.
+void bogosort_chunk(Search* search, char* chunk, size_t length, uint32_t index) {
+    SearchStats& stats = search->stats;
+    ThreadCounter& counter = stats.threads[WorkerPool::current_index()];
+    PhiloxStream rng;
+    rng.key(search->seed);
+    rng.seek(index, 0);
+
+    uint64_t count = counter.iterations.load(std::memory_order_relaxed);
+    uint64_t attempts = 0;
+    while (!std::is_sorted(chunk, chunk + length)) {
+        if ((attempts & (BATCH_ITERATIONS - 1)) == 0 && stats.stopped.load(std::memory_order_relaxed))
+            return;
+        shuffle_digits(chunk, length, rng);
+        ++attempts;
+        counter.iterations.store(++count, std::memory_order_relaxed);
+        if (attempts == 1)
+            stats.mark(stats.first_iteration_us);
+    }
+}
+
+// Runs a hybrid search on its own thread, so the logic thread keeps
+// sampling: every chunk is a task on a pool of threads workers, and once
+// all are sorted the same pool merges them.
+void run_hybrid(Search* search, int threads) {
+    SearchStats& stats = search->stats;
+    std::string chunks = search->input;
+    std::vector<size_t> bounds;
+    for (size_t start = 0; start < chunks.size(); start += HYBRID_CHUNK_DIGITS) {
+        bounds.push_back(start);
+    }
+    bounds.push_back(chunks.size());
+
+    WorkerPool pool(threads);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (size_t c = 0; c + 1 < bounds.size(); ++c) {
+        char* chunk = &chunks[bounds[c]];
+        size_t length = bounds[c + 1] - bounds[c];
+        uint32_t index = static_cast<uint32_t>(c);
+        pool.submit([search, chunk, length, index] { bogosort_chunk(search, chunk, length, index); });
+    }
+    pool.wait_idle();
+
+    std::chrono::steady_clock::time_point sorted = std::chrono::steady_clock::now();
+    stats.bogo_phase_us.store(std::chrono::duration_cast<std::chrono::microseconds>(sorted - begin).count());
+    if (stats.stopped.load())
+        return;
+    stats.publish(chunks.c_str(), false);
+
+    std::string merged;
+    parallel_merge(chunks, bounds, merged, pool, threads);
+    stats.merge_phase_us.store(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sorted).count());
+
+    stats.publish(merged.c_str(), true);
+    stop_search(*search);
+}
+
+struct CheckpointSchedule {
+    std::string path;
+    std::chrono::seconds interval;
+    std::chrono::steady_clock::time_point last;
+    uint64_t pending;
+};
+
+void write_checkpoint(Search* search, const std::string& path, int running) {
+    SearchStats& stats = search->stats;
+
+    Checkpoint checkpoint;
+    checkpoint.input = search->input;
+    checkpoint.kernel = search->control.kernel.load();
+    checkpoint.rng = search->control.rng.load();
+    checkpoint.threads = running;
+    checkpoint.seed = search->seed;
+    checkpoint.deterministic = search->deterministic;
+    {
+        std::lock_guard<std::mutex> lock(stats.snapshot_mutex);
+        checkpoint.best_key = stats.best_key.load();
+        checkpoint.best_number = stats.best_number;
+    }
+    checkpoint.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - stats.start_time).count();
+
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        WorkerSnapshot& snapshot = search->workers[i];
+        std::lock_guard<std::mutex> lock(snapshot.mutex);
+        if (!snapshot.saved)
+            continue;
+
+        WorkerCheckpoint worker;
+        worker.slot = i;
+        worker.iterations = snapshot.iterations;
+        worker.best_prefix = stats.threads[i].best_prefix.load();
+        worker.permutation = snapshot.permutation;
+        worker.rng = snapshot.rng;
+        checkpoint.workers.push_back(worker);
+    }
+
+    if (save_checkpoint(path, checkpoint))
+        stats.checkpoints++;
+    else
+        stats.checkpoint_failures++;
+}
+
+// Never waits on the workers: it moves checkpoint_epoch on, and on later
+// ticks writes the file once every running worker has copied its state out
+// at a batch boundary. A worker's only cost is that copy.
+void schedule_checkpoint(Search* search, CheckpointSchedule& schedule, int running, std::chrono::steady_clock::time_point now) {
+    if (schedule.pending) {
+        for (int i = 0; i < running; ++i) {
+            if (search->workers[i].epoch.load() < schedule.pending)
+                return;
+        }
+
+        write_checkpoint(search, schedule.path, running);
+        schedule.pending = 0;
+        schedule.last = now;
+    }
+    else if (now - schedule.last >= schedule.interval) {
+        schedule.pending = ++search->checkpoint_epoch;
+    }
+}
+
+// Grows or shrinks the worker set to target threads. Workers at or above
+// the active count leave their loop at the next batch boundary.
+void resize_workers(Search* search, std::vector<std::thread>& threads, int& running, int target) {
+    search->control.active_threads.store(target);
+
+    for (int i = target; i < running; ++i) {
+        threads[i].join();
+    }
+
+    for (int i = running; i < target; ++i) {
+        threads[i] = std::thread(search->worker, search, i);
+    }
+
+    running = target;
+}
+
+// True once a deterministic search has a find and every running worker has
+// made at least as many attempts, so no later find can beat it.
+bool every_worker_past_best(Search* search, int running) {
+    uint64_t best = search->stats.best_key.load();
+    if (best == UINT64_MAX)
+        return false;
+
+    for (int i = 0; i < running; ++i) {
+        if (search->stats.threads[i].iterations.load() < best / MAX_THREADS)
+            return false;
+    }
+    return true;
+}
+
+// Pushes one Sample per SAMPLE_INTERVAL until the search stops, applying
+// thread count changes requested from the UI and taking checkpoints in
+// between.
+void sample_throughput(Search* search, std::vector<std::thread>& threads, int& running, CheckpointSchedule* schedule) {
+    SearchStats& stats = search->stats;
+    std::vector<uint64_t> last(MAX_THREADS, 0);
+    std::chrono::steady_clock::time_point last_tick = std::chrono::steady_clock::now();
+
+    // A resumed search starts with non-zero counters.
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        last[i] = stats.threads[i].iterations.load(std::memory_order_relaxed);
+    }
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(search->mtx);
+            if (search->stopped_cv.wait_for(lock, SAMPLE_INTERVAL, [&stats] { return stats.stopped.load(); }))
+                break;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_tick).count();
+        last_tick = now;
+
+        push_sample(stats, last, now, elapsed, running);
+
+        int requested = search->control.requested_threads.load();
+        requested = std::max(1, std::min(requested, MAX_THREADS));
+        if (requested != running && search->mode != Mode::Hybrid)
+            resize_workers(search, threads, running, requested);
+
+        if (schedule)
+            schedule_checkpoint(search, *schedule, running, now);
+
+        if (search->deterministic && every_worker_past_best(search, running))
+            stop_search(*search);
+    }
+}
+
+}
+
+void push_sample(SearchStats& stats, std::vector<uint64_t>& last, std::chrono::steady_clock::time_point now, double elapsed, int threads)
+{
+    Sample sample;
+    sample.seconds = std::chrono::duration<float>(now - stats.start_time).count();
+    sample.frame_ms = stats.frame_ms.load(std::memory_order_relaxed);
+    sample.threads = threads;
+    sample.total_ips = 0.0f;
+
+    uint64_t total = 0;
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        uint64_t iterations = stats.threads[i].iterations.load(std::memory_order_relaxed);
+        sample.thread_ips[i] = static_cast<float>((iterations - last[i]) / elapsed);
+        sample.total_ips += sample.thread_ips[i];
+        total += iterations;
+        last[i] = iterations;
+    }
+
+    stats.total_iterations.store(total);
+    stats.samples.push(sample);
+}
+
+SearchEngine::SearchEngine(const std::string& input) : SearchEngine(input, bogosort_thread)
+{
+}
+
+SearchEngine::SearchEngine(const std::string& input, Worker worker) : m_search(new Search(input)), m_checkpoint_interval(0), m_resumed_us(0)
+{
+    m_search->worker = worker;
+
+    std::random_device device;
+    m_search->seed = (static_cast<uint64_t>(device()) << 32) | device();
+
+    SearchStats& stats = m_search->stats;
+    stats.snapshot = input;
+    stats.odds = compute_odds(input.c_str());
+}
+
+SearchEngine::~SearchEngine()
+{
+    stop();
+    join();
+}
+
+void SearchEngine::set_seed(uint64_t master)
+{
+    m_search->seed = master;
+    m_search->deterministic = true;
+}
+
+void SearchEngine::resume(const Checkpoint& checkpoint)
+{
+    Search& search = *m_search;
+    search.seed = checkpoint.seed;
+    search.deterministic = checkpoint.deterministic;
+    search.stats.best_key.store(checkpoint.best_key);
+    search.stats.best_number = checkpoint.best_number;
+    search.control.kernel.store(checkpoint.kernel);
+    search.control.rng.store(checkpoint.rng);
+
+    uint64_t total = 0;
+    for (const WorkerCheckpoint& worker : checkpoint.workers) {
+        if (worker.slot < 0 || worker.slot >= MAX_THREADS || worker.permutation.size() != search.input.size())
+            continue;
+
+        search.thread_numbers[worker.slot] = worker.permutation;
+        search.stats.threads[worker.slot].iterations.store(worker.iterations);
+        search.stats.threads[worker.slot].best_prefix.store(worker.best_prefix);
+
+        // Slots that don't run this time still go into later checkpoints.
+        WorkerSnapshot& snapshot = search.workers[worker.slot];
+        snapshot.saved = true;
+        snapshot.iterations = worker.iterations;
+        snapshot.permutation = worker.permutation;
+        snapshot.rng = worker.rng;
+        total += worker.iterations;
+    }
+
+    search.stats.total_iterations.store(total);
+    m_resumed_us = checkpoint.elapsed_us;
+}
+
+void SearchEngine::set_mode(Mode mode)
+{
+    m_search->mode = mode;
+}
+
+void SearchEngine::enable_checkpoints(const std::string& path, std::chrono::seconds interval)
+{
+    m_checkpoint_path = path;
+    m_checkpoint_interval = interval;
+}
+
+void SearchEngine::start(int threads, Callback on_finished)
+{
+    // Enumeration has no RNG to seed, and which worker reaches the sorted
+    // arrangement depends on how the work fell, so there is no winner to
+    // reproduce.
+    if (mode_enumerates(m_search->mode))
+        m_search->deterministic = false;
+    if (m_search->mode == Mode::Lehmer)
+        m_search->ranks = std::make_shared<RankDispenser>(m_search->input.size());
+    if (m_search->mode == Mode::Multiset || m_search->mode == Mode::Heap)
+        m_search->prefixes = std::make_shared<PrefixDispenser>(m_search->input);
+    m_search->stats.shuffle_odds = m_search->mode == Mode::Shuffle;
+    if (mode_enumerates(m_search->mode)) {
+        size_t counts[10] = {};
+        for (char digit : m_search->input) {
+            counts[digit - '0']++;
+        }
+        double log_size = std::lgamma(static_cast<double>(m_search->input.size()) + 1.0);
+        if (m_search->mode == Mode::Multiset) {
+            for (size_t count : counts) {
+                log_size -= std::lgamma(static_cast<double>(count) + 1.0);
+            }
+        }
+        m_search->stats.enumeration_size = std::exp(log_size);
+    }
+    if (m_search->mode == Mode::Anneal) {
+        InversionTracker inversions;
+        inversions.reset(m_search->input.c_str(), m_search->input.size());
+        m_search->stats.initial_inversions = inversions.remaining();
+    }
+    if (m_search->mode == Mode::Hybrid) {
+        size_t length = m_search->input.size();
+        m_search->stats.hybrid_chunks = static_cast<uint32_t>((length + HYBRID_CHUNK_DIGITS - 1) / HYBRID_CHUNK_DIGITS);
+    }
+
+    m_search->stats.start_time = std::chrono::steady_clock::now() - std::chrono::microseconds(m_resumed_us);
+    m_search->control.requested_threads.store(threads);
+    m_logic = std::thread(&SearchEngine::run, this, threads, on_finished);
+}
+
+void SearchEngine::stop()
+{
+    stop_search(*m_search);
+}
+
+void SearchEngine::join()
+{
+    if (m_logic.joinable())
+        m_logic.join();
+}
+
+void SearchEngine::run(int threads, Callback on_finished)
+{
+    Search* search = m_search.get();
+    SearchStats& stats = search->stats;
+    std::vector<std::thread> workers(MAX_THREADS);
+    int running = 0;
+
+    CheckpointSchedule schedule = { m_checkpoint_path, m_checkpoint_interval, std::chrono::steady_clock::now(), 0 };
+    CheckpointSchedule* checkpoints = m_checkpoint_path.empty() || search->mode != Mode::Shuffle ? nullptr : &schedule;
+
+    // The hybrid pool is sized once; thread count changes apply to the next
+    // search.
+    if (search->mode == Mode::Hybrid) {
+        search->control.active_threads.store(threads);
+        running = threads;
+        workers[0] = std::thread(run_hybrid, search, threads);
+    }
+    else {
+        resize_workers(search, workers, running, threads);
+    }
+
+    sample_throughput(search, workers, running, checkpoints);
+
+    for (auto& worker : workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+
+    uint64_t total = 0;
+    for (int i = 0; i < MAX_THREADS; ++i) {
+        total += stats.threads[i].iterations.load();
+    }
+    stats.total_iterations.store(total);
+
+    uint64_t best = stats.best_key.load();
+    if (search->deterministic && best != UINT64_MAX) {
+        stats.winner.store(static_cast<int>(best % MAX_THREADS));
+        stats.winner_iterations.store(best / MAX_THREADS);
+        std::string number;
+        {
+            std::lock_guard<std::mutex> lock(stats.snapshot_mutex);
+            number = stats.best_number;
+        }
+        stats.publish(number.c_str(), true);
+    }
+
+    // Every worker saved its state on the way out.
+    if (checkpoints) {
+        if (stats.success.load())
+            std::remove(m_checkpoint_path.c_str());
+        else
+            write_checkpoint(search, m_checkpoint_path, running);
+    }
+
+    stats.end_time = std::chrono::steady_clock::now();
+    stats.finished.store(true);
+
+    if (on_finished)
+        on_finished(*search);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../bogo.h"
+#include "checkpoint.h"
+
+// Runs one Search: its worker threads plus the logic thread that samples
+// throughput and applies thread count changes. It writes nothing to the
+// console and touches no global state; everything it learns goes into
+// search().stats, so any number of engines can live in one process.
+class SearchEngine
+{
+public:
+    typedef std::function<void(Search&)> Callback;
+    typedef std::function<void(Search*, int)> Worker;
+
+    // Searches input's digits with the workers every mode shares.
+    explicit SearchEngine(const std::string& input);
+
+    // Runs worker on every thread instead, with the same sampling, thread
+    // count changes, stopping and finishing. Modes, checkpoints and
+    // deterministic winners belong to the digit workers and don't apply.
+    SearchEngine(const std::string& input, Worker worker);
+
+    // Stops the search if it is still running and waits for its threads.
+    ~SearchEngine();
+
+    // Starts the logic thread, which brings up threads workers. on_finished
+    // runs on the logic thread once every worker has exited.
+    void start(int threads, Callback on_finished = Callback());
+
+    // Seeds every worker from master instead of a random seed and makes the
+    // winner deterministic. Call before start().
+    void set_seed(uint64_t master);
+
+    // Selects how workers walk the permutation space. Checkpoints only apply
+    // to Mode::Shuffle, seeds to the random modes: Shuffle, Bozo, Anneal, Frozen and Hybrid. Call before start().
+    void set_mode(Mode mode);
+
+    // Carries on from checkpoint: permutations, counters, RNG states,
+    // kernel, RNG policy and elapsed time. The engine must have been created
+    // for checkpoint.input. Call before start().
+    void resume(const Checkpoint& checkpoint);
+
+    // While running, writes a checkpoint to path every interval, and a final
+    // one if the search is stopped before the number is found. The file is
+    // removed once the number is found. Call before start().
+    void enable_checkpoints(const std::string& path, std::chrono::seconds interval);
+
+    void stop();
+    void join();
+
+    Search& search() { return *m_search; }
+
+private:
+    void run(int threads, Callback on_finished);
+
+    std::unique_ptr<Search> m_search;
+    std::thread m_logic;
+
+    std::string m_checkpoint_path;
+    std::chrono::seconds m_checkpoint_interval;
+    int64_t m_resumed_us;
+};
+
+// Pushes one Sample of each worker slot's attempts per second over the
+// elapsed seconds since the previous call, whose counts last holds, and
+// updates stats.total_iterations. Every engine's logic thread samples
+// through this, so the UI reads them all the same way.
+void push_sample(SearchStats& stats, std::vector<uint64_t>& last, std::chrono::steady_clock::time_point now, double elapsed, int threads);
@@ -0,0 +1,156 @@
+#include "worker_pool.h"
+
+#include <chrono>
+
+namespace {
+
+// Set on the pool's own threads so submit() knows which deque is local.
+thread_local const WorkerPool* t_pool = nullptr;
+thread_local int t_index = -1;
+
+}
+
+WorkerPool::WorkerPool(int threads) : m_pending(0), m_busy(0), m_next(0), m_stopping(false)
+{
+    for (int i = 0; i < threads; ++i) {
+        m_workers.emplace_back(new Worker());
+    }
+
+    for (int i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&WorkerPool::worker_loop, this, i);
+    }
+}
+
+int WorkerPool::current_index()
+{
+    return t_index;
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_cv.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+    int index = t_pool == this ? t_index : static_cast<int>(m_next++ % m_workers.size());
+    push(index, std::move(task));
+}
+
+void WorkerPool::wait_idle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle_cv.wait(lock, [this] { return m_pending.load() == 0 && m_busy.load() == 0; });
+}
+
+std::vector<WorkerPool::WorkerStats> WorkerPool::stats() const
+{
+    std::vector<WorkerStats> result;
+    for (const auto& worker : m_workers) {
+        WorkerStats stats;
+        stats.tasks = worker->executed.load();
+        stats.steals = worker->steals.load();
+        stats.failed_steals = worker->failed_steals.load();
+        stats.idle_seconds = worker->idle_us.load() / 1e6;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+void WorkerPool::push(int index, std::function<void()> task)
+{
+    m_pending++;
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+
+    // Taking m_mutex orders the push against a worker that is just about
+    // to check m_pending and go to sleep.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_work_cv.notify_one();
+}
+
+// The owner takes its oldest task, so continuations a long job pushes back
+// onto the deque queue up behind short jobs that were already waiting.
+bool WorkerPool::pop_local(int index, std::function<void()>& task)
+{
+    Worker& worker = *m_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty())
+        return false;
+
+    task = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+    m_busy++;
+    m_pending--;
+    return true;
+}
+
+// Thieves take the newest task of the first victim that has one, starting
+// with the next thread over so they don't all pile onto worker 0.
+bool WorkerPool::steal(int thief, std::function<void()>& task)
+{
+    int count = static_cast<int>(m_workers.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty())
+            continue;
+
+        task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        m_busy++;
+        m_pending--;
+        m_workers[thief]->steals++;
+        return true;
+    }
+
+    m_workers[thief]->failed_steals++;
+    return false;
+}
+
+void WorkerPool::run(int index, std::function<void()>& task)
+{
+    task();
+    task = nullptr;
+    m_workers[index]->executed++;
+
+    if (--m_busy == 0 && m_pending.load() == 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle_cv.notify_all();
+    }
+}
+
+void WorkerPool::worker_loop(int index)
+{
+    t_pool = this;
+    t_index = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (pop_local(index, task) || steal(index, task)) {
+            run(index, task);
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point idle_start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work_cv.wait(lock, [this] { return m_stopping || m_pending.load() > 0; });
+            if (m_stopping && m_pending.load() == 0)
+                return;
+        }
+        m_workers[index]->idle_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - idle_start).count();
+    }
+}
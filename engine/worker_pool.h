@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Every thread owns a deque of tasks; it runs its own
+// oldest task first and, once that deque is empty, steals the newest task
+// from another thread's deque. The threads live as long as the pool, so a
+// task only pays for a deque push instead of a thread create and join.
+class WorkerPool
+{
+public:
+    struct WorkerStats {
+        uint64_t tasks;
+        uint64_t steals;
+        uint64_t failed_steals;
+        double idle_seconds;
+    };
+
+    explicit WorkerPool(int threads);
+
+    // Runs whatever is still queued, then joins the threads.
+    ~WorkerPool();
+
+    // Called from a task, the new task goes on the running thread's own
+    // deque; from any other thread the deques are filled round robin.
+    void submit(std::function<void()> task);
+
+    // Blocks until every deque is empty and no task is running.
+    void wait_idle();
+
+    int size() const { return static_cast<int>(m_threads.size()); }
+
+    // Index of the calling thread within its pool, or -1 outside any pool.
+    static int current_index();
+
+    std::vector<WorkerStats> stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+        std::atomic<uint64_t> executed{ 0 };
+        std::atomic<uint64_t> steals{ 0 };
+        std::atomic<uint64_t> failed_steals{ 0 };
+        std::atomic<uint64_t> idle_us{ 0 };
+    };
+
+    void push(int index, std::function<void()> task);
+    bool pop_local(int index, std::function<void()>& task);
+    bool steal(int thief, std::function<void()>& task);
+    void run(int index, std::function<void()>& task);
+    void worker_loop(int index);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    // Tasks sitting in some deque. Raised before the push and lowered after
+    // the pop, so it is never below the real count.
+    std::atomic<int> m_pending;
+    std::atomic<int> m_busy;
+    std::atomic<unsigned> m_next;
+
+    // Only used to sleep and wake; the deques have their own locks.
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_idle_cv;
+    bool m_stopping;
+};
@@ -0,0 +1,164 @@
+#include "options.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+static void print_usage(const char* program)
+{
+    std::cout << "Usage: " << program << " [options] [number...]" << std::endl
+        << "  Numbers given on the command line run side by side in a grid; without any" << std::endl
+        << "  the program asks for one." << std::endl
+        << "  --threads <n>             worker threads per number instead of asking" << std::endl
+        << "  --capture <file.y4m|dir>  record every rendered frame as Y4M or a PNG sequence" << std::endl
+        << "  --tui                     show a terminal dashboard instead of opening a window" << std::endl
+        << "  --batch <file|->          sort one number per line on a shared worker pool, no window" << std::endl
+        << "  --serve <socket>          run as a daemon taking jobs over a Unix domain socket" << std::endl
+        << "  --checkpoint <file>       save the first search to file periodically and when stopped" << std::endl
+        << "  --checkpoint-every <s>    seconds between checkpoints, 60 by default" << std::endl
+        << "  --resume <file>           continue the search saved in a checkpoint file" << std::endl
+        << "  --seed <n>                reproducible run: same seed and threads give the same winner" << std::endl
+        << "  --mode <name>             shuffle (default); lehmer: enumerate disjoint rank ranges per thread;" << std::endl
+        << "                            multiset: enumerate only distinct arrangements, split by prefix;" << std::endl
+        << "                            heap: Heap's algorithm per prefix, O(1) sortedness per attempt;" << std::endl
+        << "                            bozo: swap two random digits per attempt, O(1) sortedness;" << std::endl
+        << "                            anneal: keep random swaps by simulated annealing on inversions;" << std::endl
+        << "                            frozen: lock digits that land in their sorted place, shuffle the rest;" << std::endl
+        << "                            hybrid: bogosort short chunks in parallel, then merge them" << std::endl
+        << "  --bench <mode,mode|all>   time each mode on each number given, one after another" << std::endl
+        << "  --bench-seconds <s>       longest a benchmark run may take, 5 by default" << std::endl
+        << "  --portfolio <modes|all>   race the modes on disjoint thread shares, first to sort wins" << std::endl
+        << "  --data <file>             bogosort the whitespace separated values in file, no window" << std::endl
+        << "  --element <type>          value type for --data: u8, i32, i64 (default), f32, f64," << std::endl
+        << "                            or str8, str16, str32 for strings of up to that many bytes" << std::endl
+        << "  --rng <name>              generator for --data: rand (default), mt19937 or xoshiro256" << std::endl
+        << "  --replay                  use the replayable kernel; R in the window browses the finished run" << std::endl
+        << "  --replay-attempt <t>:<a>  print attempt a of thread t for the number and --seed, then exit" << std::endl;
+}
+
+// Appends the modes in a comma separated list, or every mode for "all".
+static bool parse_mode_list(const std::string& list, std::vector<Mode>& modes)
+{
+    for (size_t start = 0; start <= list.size();) {
+        size_t end = std::min(list.find(',', start), list.size());
+        std::string name = list.substr(start, end - start);
+        Mode mode;
+        if (name == "all") {
+            for (int m = 0; m < static_cast<int>(Mode::Count); ++m) {
+                modes.push_back(static_cast<Mode>(m));
+            }
+        }
+        else if (parse_mode(name, mode)) {
+            modes.push_back(mode);
+        }
+        else {
+            std::cout << "Unknown mode: " << name << std::endl;
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool parse_options(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (!arg.empty() && arg.find_first_not_of("0123456789") == std::string::npos) {
+            options.inputs.push_back(arg);
+        }
+        else if (arg == "--threads" && has_value) {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--capture" && has_value) {
+            options.capture_path = argv[++i];
+        }
+        else if (arg == "--batch" && has_value) {
+            options.batch_path = argv[++i];
+        }
+        else if (arg == "--serve" && has_value) {
+            options.socket_path = argv[++i];
+        }
+        else if (arg == "--checkpoint" && has_value) {
+            options.checkpoint_path = argv[++i];
+        }
+        else if (arg == "--checkpoint-every" && has_value) {
+            options.checkpoint_seconds = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--resume" && has_value) {
+            options.resume_path = argv[++i];
+        }
+        else if (arg == "--seed" && has_value) {
+            options.seeded = true;
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--mode" && has_value) {
+            if (!parse_mode(argv[++i], options.mode)) {
+                std::cout << "Unknown mode: " << argv[i] << std::endl;
+                print_usage(argv[0]);
+                return false;
+            }
+        }
+        else if (arg == "--bench" && has_value) {
+            if (!parse_mode_list(argv[++i], options.bench_modes)) {
+                print_usage(argv[0]);
+                return false;
+            }
+        }
+        else if (arg == "--portfolio" && has_value) {
+            if (!parse_mode_list(argv[++i], options.portfolio_modes)) {
+                print_usage(argv[0]);
+                return false;
+            }
+        }
+        else if (arg == "--data" && has_value) {
+            options.data_path = argv[++i];
+        }
+        else if (arg == "--element" && has_value) {
+            options.element = argv[++i];
+        }
+        else if (arg == "--rng" && has_value) {
+            std::string name = argv[++i];
+            if (name == "rand")
+                options.data_rng = RngPolicy::CRand;
+            else if (name == "mt19937")
+                options.data_rng = RngPolicy::Mt19937;
+            else if (name == "xoshiro256")
+                options.data_rng = RngPolicy::Xoshiro256;
+            else {
+                std::cout << "Unknown generator: " << name << std::endl;
+                print_usage(argv[0]);
+                return false;
+            }
+        }
+        else if (arg == "--bench-seconds" && has_value) {
+            options.bench_seconds = std::max(0.01, std::atof(argv[++i]));
+        }
+        else if (arg == "--replay") {
+            options.replay = true;
+        }
+        else if (arg == "--replay-attempt" && has_value) {
+            char* end;
+            options.replay_one = true;
+            options.replay_thread = static_cast<int>(std::strtol(argv[++i], &end, 10));
+            options.replay_attempt = *end == ':' ? std::strtoull(end + 1, nullptr, 10) : 0;
+        }
+        else if (arg == "--tui") {
+            options.terminal = true;
+        }
+        else {
+            std::cout << "Unknown or incomplete option: " << arg << std::endl;
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.mode != Mode::Shuffle && (!options.checkpoint_path.empty() || !options.resume_path.empty())) {
+        std::cout << "Checkpoints only work in shuffle mode." << std::endl;
+        return false;
+    }
+
+    return true;
+}
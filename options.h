@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/modes.h"
+#include "engine/rng.h"
+
+// Command line flags. Anything not given on the command line keeps the
+// interactive prompts it had before.
+struct Options {
+    std::vector<std::string> inputs;
+    int threads = 0;
+    std::string capture_path;
+    bool terminal = false;
+    std::string batch_path;
+    std::string socket_path;
+    std::string checkpoint_path;
+    int checkpoint_seconds = 60;
+    std::string resume_path;
+    bool seeded = false;
+    uint64_t seed = 0;
+    bool replay = false;
+    bool replay_one = false;
+    int replay_thread = 0;
+    uint64_t replay_attempt = 0;
+    Mode mode = Mode::Shuffle;
+    std::vector<Mode> bench_modes;
+    double bench_seconds = 5.0;
+    std::vector<Mode> portfolio_modes;
+    std::string data_path;
+    std::string element = "i64";
+    RngPolicy data_rng = RngPolicy::CRand;
+};
+
+// Prints usage and returns false on an unknown or incomplete flag.
+bool parse_options(int argc, char* argv[], Options& options);
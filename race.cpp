@@ -0,0 +1,125 @@
+#include "race.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "engine/kernels.h"
+#include "engine/portfolio.h"
+
+namespace {
+
+const std::chrono::milliseconds POLL_INTERVAL(10);
+
+std::string format_eta(double seconds)
+{
+    if (!std::isfinite(seconds) || seconds > 1e9)
+        return "n/a";
+    std::ostringstream out;
+    out << std::setprecision(3) << seconds << " s";
+    return out.str();
+}
+
+void print_shares(Portfolio& portfolio)
+{
+    std::cout << std::fixed << std::setprecision(1) << "  " << portfolio.elapsed_seconds() << " s:";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << std::setprecision(6);
+    for (const Portfolio::Strategy& strategy : portfolio.strategies()) {
+        std::cout << "  " << MODE_NAMES[static_cast<int>(strategy.mode)] << " " << strategy.threads
+            << " (eta " << format_eta(strategy.eta_seconds) << ")";
+    }
+    std::cout << std::endl;
+}
+
+void print_result(Portfolio& portfolio)
+{
+    std::cout << std::endl << std::left << std::setw(10) << "mode" << std::right << std::setw(9) << "threads" << std::setw(12) << "thread-s"
+        << std::setw(16) << "attempts" << std::setw(11) << "progress" << "  result" << std::endl;
+
+    double total = 0.0;
+    for (size_t i = 0; i < portfolio.strategies().size(); ++i) {
+        Portfolio::Strategy& strategy = portfolio.strategies()[i];
+        SearchStats& stats = strategy.engine->search().stats;
+        double progress = strategy.done + strategy.left > 0.0 ? 100.0 * strategy.done / (strategy.done + strategy.left) : 0.0;
+        total += strategy.thread_seconds;
+        std::cout << std::left << std::setw(10) << MODE_NAMES[static_cast<int>(strategy.mode)] << std::right << std::setw(9) << strategy.threads
+            << std::fixed << std::setprecision(3) << std::setw(12) << strategy.thread_seconds << std::setw(16) << stats.total_iterations.load()
+            << std::setprecision(1) << std::setw(10) << progress << "%  " << (static_cast<int>(i) == portfolio.winner() ? "won" : stats.success.load() ? "sorted too late" : "stopped") << std::endl;
+    }
+    std::cout << std::setprecision(3);
+
+    if (portfolio.winner() < 0) {
+        std::cout << "Stopped after " << portfolio.elapsed_seconds() << " s with no winner." << std::endl << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        return;
+    }
+
+    // What the winner used is what it would have needed alone, so the
+    // ideal is that spread over every thread.
+    const Portfolio::Strategy& winner = portfolio.strategies()[portfolio.winner()];
+    double cost = portfolio.racing_cost();
+    std::cout << MODE_NAMES[static_cast<int>(winner.mode)] << " won in " << portfolio.elapsed_seconds() << " s: "
+        << winner.engine->search().stats.read_snapshot() << std::endl;
+    std::cout << "Racing cost: " << cost << " of " << total << " thread-seconds (" << std::setprecision(1) << (total > 0.0 ? 100.0 * cost / total : 0.0)
+        << std::setprecision(3) << "%) went to the other strategies; " << MODE_NAMES[static_cast<int>(winner.mode)] << " alone on " << portfolio.threads()
+        << " threads would have needed about " << winner.thread_seconds / portfolio.threads() << " s." << std::endl << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
+}
+
+int run_race(const std::vector<std::string>& inputs, const std::vector<Mode>& modes, int threads,
+    bool seeded, uint64_t seed, const std::atomic<bool>& cancel)
+{
+    std::vector<Mode> racing;
+    for (Mode mode : modes) {
+        if (mode == Mode::Hybrid)
+            std::cout << "hybrid sizes its pool once and cannot race; leaving it out." << std::endl;
+        else
+            racing.push_back(mode);
+    }
+
+    if (inputs.empty() || racing.size() < 2) {
+        std::cout << "--portfolio needs at least one number and two modes" << std::endl;
+        return 1;
+    }
+    if (threads < static_cast<int>(racing.size())) {
+        std::cout << "--portfolio needs at least one thread per mode, " << racing.size() << " here" << std::endl;
+        return 1;
+    }
+
+    for (const std::string& input : inputs) {
+        if (cancel.load())
+            return 0;
+        if (digits_sorted(input.c_str(), input.size())) {
+            std::cout << "The number " << input << " is sorted" << std::endl;
+            continue;
+        }
+
+        std::cout << "Racing";
+        for (Mode mode : racing) {
+            std::cout << " " << MODE_NAMES[static_cast<int>(mode)];
+        }
+        std::cout << " on " << threads << " threads for " << input << "." << std::endl;
+
+        Portfolio portfolio(input, racing);
+        if (seeded)
+            portfolio.set_seed(seed);
+
+        std::atomic<bool> finished(false);
+        portfolio.start(threads, print_shares, [&finished](Portfolio&) { finished.store(true); });
+        while (!finished.load() && !cancel.load()) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+        portfolio.stop();
+        portfolio.join();
+
+        print_result(portfolio);
+    }
+
+    return 0;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/modes.h"
+
+// Races the modes against each other on every input in turn, a Portfolio
+// of threads workers at a time, printing the shares as they move and a
+// table of what each strategy did once one has sorted the number. seeded
+// applies seed to the modes that take one. Returns non-zero if there was
+// nothing to race.
+int run_race(const std::vector<std::string>& inputs, const std::vector<Mode>& modes, int threads,
+    bool seeded, uint64_t seed, const std::atomic<bool>& cancel);
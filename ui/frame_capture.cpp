@@ -0,0 +1,236 @@
+#include "frame_capture.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <direct.h>
+#include <iostream>
+
+namespace {
+
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool table_ready = false;
+    if (!table_ready) {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        table_ready = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void put_u32(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void put_chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+{
+    put_u32(out, static_cast<uint32_t>(data.size()));
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put_u32(out, crc32(&out[start], out.size() - start));
+}
+
+uint8_t clamp_byte(int value)
+{
+    return static_cast<uint8_t>(std::max(0, std::min(255, value)));
+}
+
+}
+
+FrameCapture::FrameCapture(const std::string& path, int w, int h)
+    : m_path(path), m_ok(true), m_w(w), m_h(h), m_stopping(false), m_sequence(0), m_written(0), m_dropped(0)
+{
+    m_y4m = path.size() > 4 && path.compare(path.size() - 4, 4, ".y4m") == 0;
+
+    if (m_y4m) {
+        m_stream.open(path, std::ios::binary);
+        if (!m_stream) {
+            std::cout << "Failed to open capture file " << path << std::endl;
+            m_ok = false;
+            return;
+        }
+        m_stream << "YUV4MPEG2 W" << w << " H" << h << " F60:1 Ip A1:1 C420jpeg\n";
+    }
+    else {
+        _mkdir(path.c_str());
+    }
+
+    for (int i = 0; i < POOL_SIZE; ++i) {
+        m_pool.emplace_back(new Frame());
+        m_pool.back()->rgb.resize(static_cast<size_t>(w) * h * 3);
+        m_free.push_back(m_pool.back().get());
+    }
+
+    m_encoder = std::thread(&FrameCapture::encoder_loop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    if (m_encoder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_cv.notify_one();
+        m_encoder.join();
+
+        std::cout << "Captured " << m_written.load() << " frames to " << m_path
+            << ", dropped " << m_dropped.load() << "." << std::endl;
+    }
+}
+
+FrameCapture::Frame* FrameCapture::acquire()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_free.empty()) {
+        m_dropped++;
+        return nullptr;
+    }
+
+    Frame* frame = m_free.back();
+    m_free.pop_back();
+    return frame;
+}
+
+void FrameCapture::submit(Frame* frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(frame);
+    }
+    m_cv.notify_one();
+}
+
+void FrameCapture::encoder_loop()
+{
+    while (true) {
+        Frame* frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            frame = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        // A frame that failed to write is as lost as one that was never queued.
+        if (m_y4m ? write_y4m(*frame) : write_png(*frame))
+            m_written++;
+        else
+            m_dropped++;
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(frame);
+    }
+}
+
+// 4:2:0 JPEG range YCbCr, chroma averaged over each 2x2 block.
+bool FrameCapture::write_y4m(const Frame& frame)
+{
+    int cw = (m_w + 1) / 2;
+    int ch = (m_h + 1) / 2;
+    m_scratch.resize(static_cast<size_t>(m_w) * m_h + 2 * static_cast<size_t>(cw) * ch);
+
+    uint8_t* y_plane = &m_scratch[0];
+    uint8_t* u_plane = y_plane + static_cast<size_t>(m_w) * m_h;
+    uint8_t* v_plane = u_plane + static_cast<size_t>(cw) * ch;
+
+    for (int y = 0; y < m_h; ++y) {
+        const uint8_t* row = &frame.rgb[static_cast<size_t>(y) * m_w * 3];
+        for (int x = 0; x < m_w; ++x) {
+            int r = row[x * 3], g = row[x * 3 + 1], b = row[x * 3 + 2];
+            y_plane[static_cast<size_t>(y) * m_w + x] = clamp_byte((77 * r + 150 * g + 29 * b + 128) >> 8);
+        }
+    }
+
+    for (int cy = 0; cy < ch; ++cy) {
+        for (int cx = 0; cx < cw; ++cx) {
+            int r = 0, g = 0, b = 0, n = 0;
+            for (int y = cy * 2; y < std::min(cy * 2 + 2, m_h); ++y) {
+                for (int x = cx * 2; x < std::min(cx * 2 + 2, m_w); ++x) {
+                    const uint8_t* p = &frame.rgb[(static_cast<size_t>(y) * m_w + x) * 3];
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    n++;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            u_plane[static_cast<size_t>(cy) * cw + cx] = clamp_byte(((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128);
+            v_plane[static_cast<size_t>(cy) * cw + cx] = clamp_byte(((128 * r - 107 * g - 21 * b + 128) >> 8) + 128);
+        }
+    }
+
+    m_stream << "FRAME\n";
+    m_stream.write(reinterpret_cast<const char*>(&m_scratch[0]), m_scratch.size());
+    return m_stream.good();
+}
+
+// Uncompressed PNG: the image data goes into stored deflate blocks, which
+// keeps the encoder trivial and its cost bounded by the disk.
+bool FrameCapture::write_png(const Frame& frame)
+{
+    std::vector<uint8_t> raw;
+    raw.reserve(static_cast<size_t>(m_w * 3 + 1) * m_h);
+    for (int y = 0; y < m_h; ++y) {
+        raw.push_back(0);
+        const uint8_t* row = &frame.rgb[static_cast<size_t>(y) * m_w * 3];
+        raw.insert(raw.end(), row, row + m_w * 3);
+    }
+
+    std::vector<uint8_t> zlib = { 0x78, 0x01 };
+    uint32_t a = 1, b = 0;
+    size_t offset = 0;
+    do {
+        size_t block = std::min(raw.size() - offset, static_cast<size_t>(65535));
+        bool last = offset + block == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(static_cast<uint8_t>(block));
+        zlib.push_back(static_cast<uint8_t>(block >> 8));
+        zlib.push_back(static_cast<uint8_t>(~block));
+        zlib.push_back(static_cast<uint8_t>(~block >> 8));
+        for (size_t i = offset; i < offset + block; ++i) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block);
+        offset += block;
+    } while (offset < raw.size());
+    put_u32(zlib, (b << 16) | a);
+
+    std::vector<uint8_t> header;
+    put_u32(header, static_cast<uint32_t>(m_w));
+    put_u32(header, static_cast<uint32_t>(m_h));
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+    m_scratch.assign({ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' });
+    put_chunk(m_scratch, "IHDR", header);
+    put_chunk(m_scratch, "IDAT", zlib);
+    put_chunk(m_scratch, "IEND", std::vector<uint8_t>());
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%06llu.png", static_cast<unsigned long long>(m_sequence++));
+
+    std::ofstream file(m_path + name, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&m_scratch[0]), m_scratch.size());
+    return file.good();
+}
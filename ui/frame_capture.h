@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records rendered frames to disk on its own thread.
+// A path ending in .y4m produces one raw YUV4MPEG2 stream, anything else is
+// treated as a directory that receives a numbered PNG sequence.
+//
+// The UI thread takes a buffer from a fixed pool, fills it and submits it.
+// When the encoder falls behind the pool runs dry and frames are dropped;
+// the UI never waits on the disk.
+class FrameCapture
+{
+public:
+    struct Frame {
+        std::vector<uint8_t> rgb;
+    };
+
+    FrameCapture(const std::string& path, int w, int h);
+    ~FrameCapture();
+
+    bool ok() const { return m_ok; }
+    int width() const { return m_w; }
+    int height() const { return m_h; }
+
+    // Returns a free buffer of width() * height() RGB24 pixels, or nullptr
+    // when every buffer is still queued (the frame is counted as dropped).
+    Frame* acquire();
+    void submit(Frame* frame);
+
+    uint64_t written() const { return m_written.load(); }
+    uint64_t dropped() const { return m_dropped.load(); }
+
+private:
+    static const int POOL_SIZE = 8;
+
+    void encoder_loop();
+    bool write_y4m(const Frame& frame);
+    bool write_png(const Frame& frame);
+
+    std::string m_path;
+    bool m_y4m;
+    bool m_ok;
+    int m_w;
+    int m_h;
+    std::ofstream m_stream;
+
+    std::vector<std::unique_ptr<Frame>> m_pool;
+    std::vector<Frame*> m_free;
+    std::deque<Frame*> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping;
+    std::thread m_encoder;
+
+    std::vector<uint8_t> m_scratch;
+    uint64_t m_sequence;
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+
+// Parts of a frame that are timed. Text is nested inside Metadata and
+// Heatmap, everything is nested inside Draw.
+enum class FrameSection { Draw, Bars, Heatmap, Metadata, Text, ImGui, Capture, Present, Count };
+
+static const char* const FRAME_SECTION_NAMES[] = { "Draw", "Bars", "Heatmap", "Metadata", "Text", "ImGui", "Capture", "Present" };
+
+// Accumulates performance counter ticks per section for the current frame,
+// keeps the last finished frame and a running total for averages.
+class FrameProfiler
+{
+public:
+    FrameProfiler() : m_frequency(SDL_GetPerformanceFrequency()), m_frames(0)
+    {
+        for (int i = 0; i < SECTIONS; ++i) {
+            m_current[i] = m_last[i] = m_total[i] = 0;
+        }
+    }
+
+    void add(FrameSection section, Uint64 ticks) { m_current[static_cast<int>(section)] += ticks; }
+
+    void end_frame()
+    {
+        for (int i = 0; i < SECTIONS; ++i) {
+            m_last[i] = m_current[i];
+            m_total[i] += m_current[i];
+            m_current[i] = 0;
+        }
+        m_frames++;
+    }
+
+    double last_ms(FrameSection section) const { return to_ms(m_last[static_cast<int>(section)]); }
+
+    double average_ms(FrameSection section) const
+    {
+        return m_frames ? to_ms(m_total[static_cast<int>(section)]) / m_frames : 0.0;
+    }
+
+    Uint64 frames() const { return m_frames; }
+
+    void report(std::ostream& out) const
+    {
+        out << "Average frame cost over " << m_frames << " frames:" << std::endl;
+        for (int i = 0; i < SECTIONS; ++i) {
+            out << "  " << FRAME_SECTION_NAMES[i] << ": " << average_ms(static_cast<FrameSection>(i)) << " ms" << std::endl;
+        }
+    }
+
+private:
+    static const int SECTIONS = static_cast<int>(FrameSection::Count);
+
+    double to_ms(Uint64 ticks) const { return ticks * 1000.0 / m_frequency; }
+
+    Uint64 m_frequency;
+    Uint64 m_frames;
+    Uint64 m_current[SECTIONS];
+    Uint64 m_last[SECTIONS];
+    Uint64 m_total[SECTIONS];
+};
+
+class ScopedTimer
+{
+public:
+    ScopedTimer(FrameProfiler& profiler, FrameSection section)
+        : m_profiler(profiler), m_section(section), m_start(SDL_GetPerformanceCounter())
+    {
+    }
+
+    ~ScopedTimer() { m_profiler.add(m_section, SDL_GetPerformanceCounter() - m_start); }
+
+private:
+    FrameProfiler& m_profiler;
+    FrameSection m_section;
+    Uint64 m_start;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// Single producer ring of fixed size samples, readable from any thread.
+// The producer (push_sample, on the engine's sampling loop) never waits on
+// the readers (the window, the terminal dashboard, bogo_poll); it just
+// overwrites the oldest slot.
+// Each slot is a seqlock: its sequence is odd while a write is in progress
+// and 2 * (push number + 1) once it holds that push. The payload is stored
+// as relaxed atomic words, so a reader that copies a slot while the
+// producer laps it gets a torn copy rather than a data race, sees the
+// sequence move, and drops the slot.
+template <typename T, size_t N>
+class SampleRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "samples are copied word by word");
+
+public:
+    void push(const T& sample)
+    {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        Slot& slot = m_slots[head % N];
+
+        uint64_t words[WORDS] = {};
+        std::memcpy(words, &sample, sizeof(T));
+
+        slot.sequence.store(2 * head + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+        slot.sequence.store(2 * head + 2, std::memory_order_release);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    // Copies the most recent samples into out, oldest first. Slots the
+    // producer overwrote during the copy are left out.
+    size_t read(std::vector<T>& out) const
+    {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        size_t count = head < N ? static_cast<size_t>(head) : N;
+
+        out.clear();
+        out.reserve(count);
+        T sample;
+        for (uint64_t index = head - count; index < head; ++index) {
+            if (read_slot(index, sample))
+                out.push_back(sample);
+        }
+
+        return out.size();
+    }
+
+    // Copies only the newest sample. Returns false if nothing was pushed yet.
+    bool latest(T& out) const
+    {
+        while (true) {
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            if (head == 0)
+                return false;
+            if (read_slot(head - 1, out))
+                return true;
+        }
+    }
+
+    uint64_t pushed() const { return m_head.load(std::memory_order_acquire); }
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{ 0 };
+        std::atomic<uint64_t> words[WORDS]{};
+    };
+
+    // True if the slot held push index for the whole copy.
+    bool read_slot(uint64_t index, T& out) const
+    {
+        const Slot& slot = m_slots[index % N];
+        uint64_t expected = 2 * index + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected)
+            return false;
+
+        uint64_t words[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected)
+            return false;
+
+        std::memcpy(&out, words, sizeof(T));
+        return true;
+    }
+
+    Slot m_slots[N];
+    std::atomic<uint64_t> m_head{ 0 };
+};
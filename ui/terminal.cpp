@@ -0,0 +1,234 @@
+#include "terminal.h"
+
+#include <Windows.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const std::chrono::milliseconds REDRAW_INTERVAL(250);
+const int MAX_THREAD_COLUMNS = 8;
+
+// Eight block heights, as UTF-8.
+const char* const SPARKS[] = { "\xe2\x96\x81", "\xe2\x96\x82", "\xe2\x96\x83", "\xe2\x96\x84", "\xe2\x96\x85", "\xe2\x96\x86", "\xe2\x96\x87", "\xe2\x96\x88" };
+
+std::string format_rate(double value)
+{
+    char buffer[32];
+    if (value >= 1e12)
+        std::snprintf(buffer, sizeof(buffer), "%.2e", value);
+    else if (value >= 1e9)
+        std::snprintf(buffer, sizeof(buffer), "%.2fG", value / 1e9);
+    else if (value >= 1e6)
+        std::snprintf(buffer, sizeof(buffer), "%.2fM", value / 1e6);
+    else if (value >= 1e3)
+        std::snprintf(buffer, sizeof(buffer), "%.1fk", value / 1e3);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    return buffer;
+}
+
+// Visible columns of the console window, or 80 when stdout is not one.
+int console_width()
+{
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+        return 80;
+    return std::max(20, static_cast<int>(info.srWindow.Right - info.srWindow.Left + 1));
+}
+
+// Cuts text after columns code points. Every character the dashboard
+// prints is one column wide, the spark blocks included.
+void fit_line(std::string& text, int columns)
+{
+    int seen = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if ((static_cast<unsigned char>(text[i]) & 0xc0) == 0x80)
+            continue;
+        if (seen++ == columns) {
+            text.resize(i);
+            return;
+        }
+    }
+}
+
+std::string format_seconds(double seconds)
+{
+    if (seconds > 1e9)
+        return "never";
+
+    char buffer[48];
+    long long whole = static_cast<long long>(seconds);
+    if (whole >= 86400)
+        std::snprintf(buffer, sizeof(buffer), "%lldd %02lldh %02lldm", whole / 86400, whole / 3600 % 24, whole / 60 % 60);
+    else if (whole >= 60)
+        std::snprintf(buffer, sizeof(buffer), "%lldh %02lldm %02llds", whole / 3600, whole / 60 % 60, whole % 60);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%.2fs", seconds);
+    return buffer;
+}
+
+}
+
+TerminalUI::TerminalUI(SearchStats* stats) : stats(stats), m_lines(0)
+{
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (GetConsoleMode(out, &mode))
+        SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    SetConsoleOutputCP(CP_UTF8);
+
+    std::cout << "\x1b[?25l" << std::flush;
+}
+
+TerminalUI::~TerminalUI()
+{
+    std::cout << "\x1b[?25h" << std::flush;
+}
+
+void TerminalUI::update()
+{
+    // main prints each search's banner before starting its engine, so once
+    // a worker has iterated the dashboard owns the bottom of the console.
+    while (stats->first_iteration_us.load() < 0 && !stats->stopped.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    while (true) {
+        {
+            // Once the search has stopped other threads print below the
+            // dashboard, so it must not move the cursor back up again.
+            std::lock_guard<std::mutex> lock(console_mutex());
+            if (stats->stopped.load())
+                return;
+            draw();
+        }
+        std::this_thread::sleep_for(REDRAW_INTERVAL);
+    }
+}
+
+void TerminalUI::draw()
+{
+    stats->samples.read(m_samples);
+
+    std::string digits = stats->read_snapshot();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - stats->start_time).count();
+    uint64_t attempts = stats->total_iterations.load();
+    const Odds& odds = stats->odds;
+
+    // Cursor movement counts rows, so no line may wrap: each one stops a
+    // column short of the edge, where some consoles wrap early.
+    int columns = console_width() - 1;
+
+    std::ostringstream frame;
+    if (m_lines)
+        frame << "\x1b[" << m_lines << "F";
+
+    int lines = 0;
+    std::ostringstream line;
+    auto end_line = [&frame, &line, &lines, columns]() {
+        std::string text = line.str();
+        fit_line(text, columns);
+        frame << text << "\x1b[K\n";
+        line.str(std::string());
+        lines++;
+    };
+
+    line << "bogo " << digits.size() << " digits, elapsed " << format_seconds(elapsed);
+    end_line();
+
+    // One spark per digit beside the digits while both fit; past that the
+    // sparkline averages runs of digits into the width and the digits get
+    // a line of their own, cut short.
+    size_t length = digits.size();
+    if (length * 2 + 2 <= static_cast<size_t>(columns)) {
+        for (char c : digits) {
+            int digit = std::max(0, std::min(9, c - '0'));
+            line << SPARKS[digit * 7 / 9];
+        }
+        line << "  " << digits;
+        end_line();
+    }
+    else {
+        size_t sparks = std::min(length, static_cast<size_t>(columns));
+        for (size_t i = 0; i < sparks; ++i) {
+            size_t from = i * length / sparks;
+            size_t to = std::max(from + 1, (i + 1) * length / sparks);
+            int sum = 0;
+            for (size_t j = from; j < to; ++j) {
+                sum += std::max(0, std::min(9, digits[j] - '0'));
+            }
+            line << SPARKS[sum * 7 / (9 * static_cast<int>(to - from))];
+        }
+        end_line();
+
+        if (length > static_cast<size_t>(columns))
+            line << digits.substr(0, columns - 3) << "...";
+        else
+            line << digits;
+        end_line();
+    }
+
+    if (m_samples.empty()) {
+        line << "waiting for the first sample";
+        end_line();
+    }
+    else {
+        const Sample& latest = m_samples.back();
+
+        line << "total " << format_rate(latest.total_ips) << " it/s, attempts " << format_rate(static_cast<double>(attempts));
+        if (stats->shuffle_odds) {
+            // Shuffles are memoryless, so the expected wait never shrinks;
+            // the percentile ETAs count down to fixed points of the
+            // distribution.
+            double eta = latest.total_ips > 0.0f ? odds.expected_attempts / latest.total_ips : 1e18;
+            line << " of ~" << format_rate(odds.expected_attempts) << " expected, ETA " << format_seconds(eta);
+            end_line();
+
+            char percentile[16];
+            std::snprintf(percentile, sizeof(percentile), "%.2f%%", 100.0 * success_percentile(odds, static_cast<double>(attempts)));
+            line << "odds " << odds.ratio << ", at the " << percentile << " percentile, 50% in "
+                << format_seconds(seconds_to_percentile(odds, static_cast<double>(attempts), latest.total_ips, 0.5))
+                << ", 95% in " << format_seconds(seconds_to_percentile(odds, static_cast<double>(attempts), latest.total_ips, 0.95));
+        }
+        else if (stats->enumeration_size > 0.0) {
+            // An enumeration tries each arrangement once, so it is done by
+            // the end of the space at the latest.
+            char walked[16];
+            std::snprintf(walked, sizeof(walked), "%.2f%%", 100.0 * static_cast<double>(attempts) / stats->enumeration_size);
+            double left = std::max(0.0, stats->enumeration_size - static_cast<double>(attempts));
+            line << " of " << format_rate(stats->enumeration_size) << ", " << walked << " walked, done within "
+                << format_seconds(latest.total_ips > 0.0f ? left / latest.total_ips : 1e18);
+        }
+        end_line();
+
+        if (stats->initial_inversions) {
+            uint64_t left = stats->inversions_left();
+            line << "inversions left " << left << " of " << stats->initial_inversions << ", "
+                << 100.0 * (stats->initial_inversions - left) / stats->initial_inversions << "% done";
+            end_line();
+        }
+
+        for (int i = 0; i < latest.threads; ++i) {
+            if (i % MAX_THREAD_COLUMNS == 0) {
+                if (i)
+                    end_line();
+                line << "threads";
+            }
+            line << "  T" << i << " " << format_rate(latest.thread_ips[i]);
+        }
+        end_line();
+    }
+
+    // Clear whatever an earlier, taller frame left below.
+    frame << "\x1b[J";
+    m_lines = lines;
+
+    std::string text = frame.str();
+    std::fwrite(text.data(), 1, text.size(), stdout);
+    std::fflush(stdout);
+}
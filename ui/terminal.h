@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../bogo.h"
+#include "../console.h"
+
+// Text dashboard for sessions without a display, e.g. over SSH.
+// Redraws a fixed block of lines in place with ANSI escapes a few times per
+// second, reading the same SearchStats as the SDL UI.
+class TerminalUI
+{
+public:
+    TerminalUI(SearchStats* stats);
+    ~TerminalUI();
+
+    // Redraws until the search stops.
+    void update();
+
+private:
+    void draw();
+
+    SearchStats* stats;
+    std::vector<Sample> m_samples;
+    int m_lines;
+};
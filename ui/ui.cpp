@@ -1,9 +1,11 @@
 #include "ui.h"
 
-UI::UI(int w, int h)
+UI::UI(int w, int h) : success(false), total_iterations(0), stats(nullptr), font(nullptr)
 {
 
-    if (SDL_Init(SDL_INIT_EVERYTHING) < 0) {
+    // Only video: audio, haptics and game controllers are never used and
+    // add to startup time.
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cout << "Error initializing SDL: " << SDL_GetError() << std::endl;
         return;
     }
@@ -20,6 +22,7 @@ UI::UI(int w, int h)
 
     totalFrameTicks = 0;
     totalFrames = 0;
+    lastFramePerf = SDL_GetPerformanceCounter();
 
     m_window = SDL_CreateWindow("Bogo",
         SDL_WINDOWPOS_CENTERED,
@@ -43,13 +46,16 @@ UI::UI(int w, int h)
 		return;
 	}
 
-    font = TTF_OpenFont("OpenSans.ttf", 60);
-    if (!font)
-    {
-		std::cout << "Failed to load font" << std::endl;
-		std::cout << "SDL2 Error: " << SDL_GetError() << std::endl;
-		return;
-	}
+    font_loader = std::thread([this] {
+        TTF_Font* loaded = TTF_OpenFont("OpenSans.ttf", 60);
+        if (!loaded)
+        {
+            std::cout << "Failed to load font" << std::endl;
+            std::cout << "SDL2 Error: " << SDL_GetError() << std::endl;
+            return;
+        }
+        font.store(loaded);
+    });
 
 #ifdef USE_IMGUI
     IMGUI_CHECKVERSION();
@@ -70,6 +76,12 @@ UI::UI(int w, int h)
 
 UI::~UI()
 {
+    profiler.report(std::cout);
+    capture.reset();
+    if (font_loader.joinable())
+        font_loader.join();
+    if (font.load())
+        TTF_CloseFont(font.load());
 #ifdef USE_IMGUI
     ImGui_ImplSDLRenderer2_Shutdown();
     ImGui_ImplSDL2_Shutdown();
@@ -88,6 +100,10 @@ void UI::update()
         startTicks = SDL_GetTicks();
         startPerf = SDL_GetPerformanceCounter();
 
+        float frame_ms = (startPerf - lastFramePerf) * 1000.0f / SDL_GetPerformanceFrequency();
+        stats->frame_ms.store(frame_ms, std::memory_order_relaxed);
+        lastFramePerf = startPerf;
+
         while (SDL_PollEvent(&m_window_event) > 0)
         {
 #ifdef USE_IMGUI
@@ -119,6 +135,40 @@ void UI::update()
                 case SDLK_q:
                     running = false;
                     break;
+                    // H key
+                case SDLK_h:
+                    show_heatmap = !show_heatmap;
+                    break;
+                    // Replay: R toggles, left/right step one attempt,
+                    // page up/down a hundredth of the run, up/down change
+                    // thread, home/end jump to the ends
+                case SDLK_r:
+                    toggle_replay();
+                    break;
+                case SDLK_LEFT:
+                    step_replay(0, -1);
+                    break;
+                case SDLK_RIGHT:
+                    step_replay(0, 1);
+                    break;
+                case SDLK_PAGEDOWN:
+                    step_replay(0, -std::max<int64_t>(1, stats->threads[replay_thread].iterations.load() / 100));
+                    break;
+                case SDLK_PAGEUP:
+                    step_replay(0, std::max<int64_t>(1, stats->threads[replay_thread].iterations.load() / 100));
+                    break;
+                case SDLK_HOME:
+                    step_replay(0, INT64_MIN);
+                    break;
+                case SDLK_END:
+                    step_replay(0, INT64_MAX);
+                    break;
+                case SDLK_UP:
+                    step_replay(1, 0);
+                    break;
+                case SDLK_DOWN:
+                    step_replay(-1, 0);
+                    break;
 #ifdef USE_IMGUI
                     // D key
                 case SDLK_d:
@@ -128,6 +178,18 @@ void UI::update()
                 case SDLK_m:
                     show_tool_metrics = !show_tool_metrics;
                     break;
+                    // P key
+                case SDLK_p:
+                    show_dashboard = !show_dashboard;
+                    break;
+                    // C key
+                case SDLK_c:
+                    show_control_panel = !show_control_panel;
+                    break;
+                    // F key
+                case SDLK_f:
+                    show_frame_cost = !show_frame_cost;
+                    break;
 #endif // USE_IMGUI
 
                 }
@@ -139,19 +201,204 @@ void UI::update()
     }
 }
 
+void UI::add_search(SearchStats* search_stats, const std::string& label)
+{
+    Tile tile = { search_stats, label, label, false, 0.0f };
+    m_tiles.push_back(tile);
+    if (!stats)
+        stats = search_stats;
+}
+
+void UI::enable_replay(const std::string& input, uint64_t seed)
+{
+    replay_enabled = true;
+    replay_input = input;
+    replay_seed = seed;
+}
+
+// Starts at the winning attempt, or at thread 0's last one if the search
+// was stopped.
+void UI::toggle_replay()
+{
+    if (!replay_enabled || !stats->finished.load())
+        return;
+
+    replaying = !replaying;
+    if (replaying) {
+        int winner = stats->winner.load();
+        replay_thread = winner >= 0 ? winner : 0;
+        replay_attempt_number = winner >= 0 ? stats->winner_iterations.load() : stats->threads[0].iterations.load();
+        step_replay(0, 0);
+    }
+}
+
+// Moves to the next thread that ran in the direction of thread_step, then
+// moves attempt_step attempts, clamped to the attempts that thread made.
+void UI::step_replay(int thread_step, int64_t attempt_step)
+{
+    if (!replaying)
+        return;
+
+    if (thread_step) {
+        for (int i = 1; i < MAX_THREADS; ++i) {
+            int thread = (replay_thread + thread_step * i + MAX_THREADS) % MAX_THREADS;
+            if (stats->threads[thread].iterations.load() > 0) {
+                replay_thread = thread;
+                break;
+            }
+        }
+    }
+
+    uint64_t last = stats->threads[replay_thread].iterations.load();
+    if (attempt_step == INT64_MIN)
+        replay_attempt_number = 1;
+    else if (attempt_step == INT64_MAX)
+        replay_attempt_number = last;
+    else if (attempt_step < 0)
+        replay_attempt_number -= std::min(replay_attempt_number - 1, static_cast<uint64_t>(-attempt_step));
+    else
+        replay_attempt_number += static_cast<uint64_t>(attempt_step);
+
+    replay_attempt_number = std::max<uint64_t>(1, std::min(replay_attempt_number, last));
+}
+
+void UI::sync_stats()
+{
+    Sample sample;
+    for (Tile& tile : m_tiles) {
+        tile.current_iteration = tile.stats->read_snapshot();
+        tile.success = tile.stats->success.load();
+        tile.ips = tile.stats->samples.latest(sample) ? sample.total_ips : 0.0f;
+    }
+
+    if (replaying && replay_attempt_number > 0) {
+        ReplayKey key = { replay_input.c_str(), replay_seed, static_cast<uint32_t>(replay_thread) };
+        m_tiles[0].current_iteration.resize(replay_input.size());
+        replay_attempt(&m_tiles[0].current_iteration[0], replay_input.size(), key, replay_attempt_number);
+        m_tiles[0].success = digits_sorted(m_tiles[0].current_iteration.c_str(), replay_input.size());
+    }
+
+    current_iteration = m_tiles[0].current_iteration;
+    total_iterations = stats->total_iterations.load();
+    start_time = stats->start_time;
+    success = m_tiles[0].success;
+    render_number(current_iteration.c_str());
+}
+
+void UI::push_quad(SDL_Rect rect, SDL_Color color)
+{
+    if (rect.h < 0) {
+        rect.y += rect.h;
+        rect.h = -rect.h;
+    }
+
+    int base = static_cast<int>(m_vertices.size());
+    float x0 = static_cast<float>(rect.x);
+    float y0 = static_cast<float>(rect.y);
+    float x1 = static_cast<float>(rect.x + rect.w);
+    float y1 = static_cast<float>(rect.y + rect.h);
+
+    m_vertices.push_back({ { x0, y0 }, color, { 0.0f, 0.0f } });
+    m_vertices.push_back({ { x1, y0 }, color, { 0.0f, 0.0f } });
+    m_vertices.push_back({ { x0, y1 }, color, { 0.0f, 0.0f } });
+    m_vertices.push_back({ { x1, y1 }, color, { 0.0f, 0.0f } });
+
+    const int corners[] = { 0, 1, 2, 1, 3, 2 };
+    for (int corner : corners) {
+        m_indices.push_back(base + corner);
+    }
+}
+
+void UI::flush_geometry()
+{
+    if (!m_vertices.empty())
+        SDL_RenderGeometry(m_window_renderer, NULL, m_vertices.data(), static_cast<int>(m_vertices.size()), m_indices.data(), static_cast<int>(m_indices.size()));
+
+    m_vertices.clear();
+    m_indices.clear();
+}
+
+// Lays the searches out on a near-square grid. Each tile gets at most one
+// bar per four pixels; longer numbers are downsampled by averaging runs of
+// digits. All bars go out in one batch, then each tile gets its label and
+// rate on top.
+void UI::render_grid()
+{
+    const int label_h = 16;
+
+    int count = static_cast<int>(m_tiles.size());
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    int rows = (count + columns - 1) / columns;
+    int tile_w = screen_w / columns;
+    int tile_h = screen_h / rows;
+
+    for (int t = 0; t < count; ++t) {
+        const Tile& tile = m_tiles[t];
+        int x = (t % columns) * tile_w;
+        int y = (t / columns) * tile_h;
+        int bar_area_h = tile_h - label_h - 4;
+
+        int length = static_cast<int>(tile.current_iteration.size());
+        int bars = std::max(1, std::min(length, tile_w / 4));
+        int group = (length + bars - 1) / bars;
+        bars = (length + group - 1) / group;
+        int bar_w = std::max(1, (tile_w - 4) / bars);
+
+        SDL_Color color = tile.success ? SDL_Color{ 0, 255, 0, 255 } : SDL_Color{ 255, 255, 255, 255 };
+
+        for (int b = 0; b < bars; ++b) {
+            int sum = 0;
+            int end = std::min(length, (b + 1) * group);
+            for (int i = b * group; i < end; ++i) {
+                sum += tile.current_iteration[i] - '0';
+            }
+            float value = static_cast<float>(sum) / (end - b * group);
+
+            SDL_Rect bar;
+            bar.w = std::max(1, bar_w - 1);
+            bar.h = static_cast<int>(bar_area_h * (value + 1.0f) / 10.0f);
+            bar.x = x + 2 + b * bar_w;
+            bar.y = y + tile_h - 2 - bar.h;
+            push_quad(bar, color);
+        }
+
+        // Tile border, drawn as four thin quads so it joins the batch.
+        SDL_Color border = { 70, 70, 70, 255 };
+        push_quad({ x, y, tile_w, 1 }, border);
+        push_quad({ x, y, 1, tile_h }, border);
+        push_quad({ x, y + tile_h - 1, tile_w, 1 }, border);
+        push_quad({ x + tile_w - 1, y, 1, tile_h }, border);
+    }
+
+    flush_geometry();
+
+    for (int t = 0; t < count; ++t) {
+        const Tile& tile = m_tiles[t];
+        std::string label = tile.label.size() > 16 ? tile.label.substr(0, 13) + "..." : tile.label;
+        std::string rate = tile.success ? "sorted" : std::to_string(static_cast<int>(tile.ips)) + " it/s";
+
+        SDL_Rect dest;
+        dest.x = (t % columns) * tile_w + 4;
+        dest.y = (t / columns) * tile_h + 2;
+        dest.w = tile_w / 2 - 8;
+        dest.h = label_h;
+        text(label + "  " + rate, dest);
+    }
+}
+
 void UI::render_metadata() {
 
     Uint32 endTicks = SDL_GetTicks();
     Uint64 endPerf = SDL_GetPerformanceCounter();
-    Uint64 framePerf = endPerf - startPerf;
+    double framePerf = (endPerf - startPerf) * 1000.0 / SDL_GetPerformanceFrequency();
     float frameTime = (endTicks - startTicks) / 1000.0f;
     totalFrameTicks += endTicks - startTicks;
 
     std::string fps = "Current FPS: " + std::to_string(1.0f / frameTime);
     std::string avg = "Average FPS: " + std::to_string(1000.0f / ((float)totalFrameTicks / totalFrames));
-    std::string perf = "Current Perf: " + std::to_string(framePerf);
+    std::string perf = "Current Perf: " + std::to_string(framePerf).substr(0, 5) + " ms, last draw " + std::to_string(profiler.last_ms(FrameSection::Draw)).substr(0, 5) + " ms";
 
-    std::string current_num = "Current Number: " + std::string(current_iteration);
+    std::string current_num = "Current Number: " + current_iteration;
     std::string total_num = "Total Iterations: " + std::to_string(total_iterations);
 
     double interations_per_second = static_cast<double>(total_iterations) / std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_time).count();
@@ -171,6 +418,44 @@ void UI::render_metadata() {
     metadata_rect.y = 40;
     text(perf, metadata_rect);
 
+    // Odds and ETAs for shuffles, how far through the space for an
+    // enumeration, nothing for the modes neither model describes.
+    double attempts = static_cast<double>(total_iterations);
+    auto format_eta = [](double seconds) {
+        return seconds > 1e12 ? std::string("never") : std::to_string(static_cast<long long>(seconds)) + " s";
+    };
+    std::string odds;
+    std::string etas;
+    if (stats->shuffle_odds) {
+        std::string percentile = std::to_string(100.0 * success_percentile(stats->odds, attempts));
+        odds = "Odds: " + stats->odds.ratio + ", percentile " + percentile.substr(0, percentile.find(".") + 3) + "%";
+        auto eta = [this, attempts, &format_eta](double target) {
+            return format_eta(seconds_to_percentile(stats->odds, attempts, m_tiles[0].ips, target));
+        };
+        etas = "ETA: 50% in " + eta(0.5) + ", 95% in " + eta(0.95);
+    }
+    else if (stats->enumeration_size > 0.0) {
+        std::string walked = std::to_string(100.0 * attempts / stats->enumeration_size);
+        odds = "Walked: " + walked.substr(0, walked.find(".") + 3) + "% of the arrangements";
+        double left = std::max(0.0, stats->enumeration_size - attempts);
+        etas = "Done within: " + format_eta(m_tiles[0].ips > 0.0f ? left / m_tiles[0].ips : 1e18);
+    }
+
+    metadata_rect.y = 60;
+    metadata_rect.w = screen_w / 10 * 2;
+    if (!odds.empty())
+        text(odds, metadata_rect);
+
+    metadata_rect.y = 80;
+    if (!etas.empty())
+        text(etas, metadata_rect);
+
+    if (stats->initial_inversions) {
+        std::string inversions = "Inversions left: " + std::to_string(stats->inversions_left()) + " of " + std::to_string(stats->initial_inversions);
+        metadata_rect.y = 100;
+        text(inversions, metadata_rect);
+    }
+
     metadata_rect.x = screen_w / 10 * 8;
     metadata_rect.y = 0;
     metadata_rect.w = screen_w / 10 * 2;
@@ -184,49 +469,408 @@ void UI::render_metadata() {
     metadata_rect.y = 40;
     text(ips, metadata_rect);
 
+    int64_t first_iteration = stats->first_iteration_us.load();
+    int64_t first_frame = stats->first_frame_us.load();
+    std::string startup = "Startup: first iteration " + std::to_string(first_iteration / 1000) + " ms, first frame " + std::to_string(first_frame / 1000) + " ms";
+    metadata_rect.y = 60;
+    text(startup, metadata_rect);
+
+    if (replaying) {
+        std::string replay = "Replay: thread " + std::to_string(replay_thread) + ", attempt " + std::to_string(replay_attempt_number)
+            + " of " + std::to_string(stats->threads[replay_thread].iterations.load());
+        metadata_rect.y = 80;
+        text(replay, metadata_rect);
+    }
+
 }
 
-void UI::draw()
+// Draws how often each digit landed in each position behind the bars, merged
+// from every worker's histogram. Each column is split into ten rows, digit 9
+// on top. Grey means the digit shows up as often as its share of the input
+// predicts; red is more often, blue less, saturating at +-25%.
+void UI::render_heatmap()
 {
+    const float saturation = 0.25f;
+
+    if (current_iteration.empty())
+        return;
+
+    int length = static_cast<int>(m_rects.size());
+    int positions = std::min(length, HEATMAP_POSITIONS);
+    if (positions == 0)
+        return;
+
+    int digit_count[10] = { 0 };
+    for (int i = 0; i < length; ++i) {
+        int digit = current_iteration[i] - '0';
+        if (digit >= 0 && digit < 10)
+            digit_count[digit]++;
+    }
+
+    uint64_t cells[HEATMAP_POSITIONS][10] = { { 0 } };
+    uint64_t samples = 0;
+    for (int t = 0; t < MAX_THREADS; ++t) {
+        for (int i = 0; i < positions; ++i) {
+            for (int d = 0; d < 10; ++d) {
+                cells[i][d] += stats->threads[t].digit_positions[i][d].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    for (int d = 0; d < 10; ++d) {
+        samples += cells[0][d];
+    }
+    if (samples == 0)
+        return;
 
-    SDL_RenderClear(m_window_renderer);
+    // Below the metadata rows, the last of which is the deviation label.
+    int top = 140;
+    int row_h = (screen_h - 10 - top) / 10;
+    float max_deviation = 0.0f;
+
+    for (int i = 0; i < positions; ++i) {
+        for (int d = 0; d < 10; ++d) {
+            if (!digit_count[d])
+                continue;
+
+            float expected = static_cast<float>(samples) * digit_count[d] / length;
+            float deviation = static_cast<float>(cells[i][d]) / expected - 1.0f;
+            max_deviation = std::max(max_deviation, std::abs(deviation));
+
+            float k = std::max(-1.0f, std::min(1.0f, deviation / saturation));
+            Uint8 r = static_cast<Uint8>(k > 0 ? 60 + 195 * k : 60 * (1 + k));
+            Uint8 b = static_cast<Uint8>(k < 0 ? 60 - 195 * k : 60 * (1 - k));
+            Uint8 g = static_cast<Uint8>(60 * (1 - std::abs(k)));
+
+            SDL_Rect cell;
+            cell.x = (screen_w / length) * i;
+            cell.y = top + row_h * (9 - d);
+            cell.w = (screen_w / length) - 1;
+            cell.h = row_h - 1;
+
+            SDL_SetRenderDrawColor(m_window_renderer, r, g, b, 255);
+            SDL_RenderFillRect(m_window_renderer, &cell);
+        }
+    }
+
+    std::string deviation_text = "Heatmap Max Deviation: " + std::to_string(max_deviation * 100.0f).substr(0, 4) + "%";
+    SDL_Rect text_rect;
+    text_rect.x = 0;
+    text_rect.y = 120;
+    text_rect.w = screen_w / 10;
+    text_rect.h = 20;
+    text(deviation_text, text_rect);
+}
 
 #ifdef USE_IMGUI
-    ImGui_ImplSDLRenderer2_NewFrame();
-    ImGui_ImplSDL2_NewFrame();
-    ImGui::NewFrame();
-#endif
+void UI::render_dashboard()
+{
+    int count = static_cast<int>(dashboard_samples.size());
 
-    if (success)
-        SDL_SetRenderDrawColor(m_window_renderer, 0, 255, 0, 255);
-    else 
-        SDL_SetRenderDrawColor(m_window_renderer, 255, 255, 255, 255);
+    ImGui::SetNextWindowSize(ImVec2(420, 0), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Throughput", &show_dashboard) || count == 0) {
+        ImGui::End();
+        return;
+    }
 
-    for (int i = 0; i < m_rects.size(); ++i)
-    {
-        auto rect = m_rects[i];
-        SDL_RenderDrawRect(m_window_renderer, &rect);
-        SDL_RenderFillRect(m_window_renderer, &rect);
+    const Sample& latest = dashboard_samples[count - 1];
+    const ImVec2 plot_size(0, 60);
+
+    std::string overlay = std::to_string(static_cast<int>(latest.total_ips)) + " it/s";
+    ImGui::PlotLines("Total", &dashboard_samples[0].total_ips, count, 0, overlay.c_str(), 0.0f, FLT_MAX, plot_size, sizeof(Sample));
+
+    overlay = std::to_string(latest.frame_ms).substr(0, 5) + " ms";
+    ImGui::PlotLines("Frame", &dashboard_samples[0].frame_ms, count, 0, overlay.c_str(), 0.0f, FLT_MAX, plot_size, sizeof(Sample));
+
+    if (ImGui::CollapsingHeader("Per thread", ImGuiTreeNodeFlags_DefaultOpen)) {
+        for (int i = 0; i < latest.threads; ++i) {
+            std::string label = "Thread " + std::to_string(i);
+            overlay = std::to_string(static_cast<int>(latest.thread_ips[i])) + " it/s";
+            ImGui::PlotLines(label.c_str(), &dashboard_samples[0].thread_ips[i], count, 0, overlay.c_str(), 0.0f, FLT_MAX, ImVec2(0, 30), sizeof(Sample));
+        }
     }
 
-    render_metadata();
+    ImGui::Text("%.1f s, %d samples", latest.seconds, count);
+    if (capture)
+        ImGui::Text("Capture: %llu written, %llu dropped", static_cast<unsigned long long>(capture->written()), static_cast<unsigned long long>(capture->dropped()));
+    ImGui::End();
+}
 
-    SDL_SetRenderDrawColor(m_window_renderer, 0, 0, 0, 255);
+// Sliders over a finished run's history; the keyboard does the same.
+void UI::render_replay_panel()
+{
+    if (!ImGui::Begin("Replay")) {
+        ImGui::End();
+        return;
+    }
+
+    bool active = replaying;
+    if (ImGui::Checkbox("Replay (R)", &active))
+        toggle_replay();
+
+    if (replaying) {
+        int thread = replay_thread;
+        if (ImGui::SliderInt("Thread", &thread, 0, MAX_THREADS - 1) && stats->threads[thread].iterations.load() > 0) {
+            replay_thread = thread;
+            step_replay(0, 0);
+        }
+
+        uint64_t first = 1;
+        uint64_t last = stats->threads[replay_thread].iterations.load();
+        ImGui::SliderScalar("Attempt", ImGuiDataType_U64, &replay_attempt_number, &first, &last);
+        step_replay(0, 0);
+
+        ImGui::Text("%s", m_tiles[0].success ? "Sorted" : "Not sorted");
+    }
+
+    ImGui::End();
+}
+
+// Last frame and running average cost of every timed section, with its
+// share of the whole draw.
+void UI::render_frame_cost()
+{
+    if (!ImGui::Begin("Frame Cost", &show_frame_cost) ||
+        !ImGui::BeginTable("sections", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::TableSetupColumn("Section");
+    ImGui::TableSetupColumn("Last ms");
+    ImGui::TableSetupColumn("Avg ms");
+    ImGui::TableSetupColumn("Share");
+    ImGui::TableHeadersRow();
+
+    double draw = profiler.average_ms(FrameSection::Draw);
+    for (int i = 0; i < static_cast<int>(FrameSection::Count); ++i) {
+        FrameSection section = static_cast<FrameSection>(i);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(FRAME_SECTION_NAMES[i]);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", profiler.last_ms(section));
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", profiler.average_ms(section));
+        ImGui::TableNextColumn();
+        if (draw > 0.0)
+            ImGui::Text("%.1f%%", profiler.average_ms(section) / draw * 100.0);
+    }
+
+    ImGui::EndTable();
+    ImGui::TextDisabled("Text is part of Heatmap and Metadata; Present includes the vsync wait.");
+    ImGui::End();
+}
+
+// Mean total throughput of the samples taken in [from, to), or -1 if there
+// are none yet.
+float UI::average_ips(float from, float to)
+{
+    double sum = 0.0;
+    int count = 0;
+    for (const Sample& sample : dashboard_samples) {
+        if (sample.seconds >= from && sample.seconds < to) {
+            sum += sample.total_ips;
+            ++count;
+        }
+    }
+
+    return count ? static_cast<float>(sum / count) : -1.0f;
+}
+
+void UI::render_control_panel()
+{
+    // Throughput is compared over two seconds on each side of a change,
+    // skipping the first half second after it while workers pick it up.
+    const float window = 2.0f;
+    const float settle = 0.5f;
+
+    if (!control || dashboard_samples.empty())
+        return;
+
+    if (!ImGui::Begin("Control", &show_control_panel)) {
+        ImGui::End();
+        return;
+    }
+
+    float now = dashboard_samples.back().seconds;
+    std::string change;
+
+    int kernel = control->kernel.load();
+    if (ImGui::Combo("Kernel", &kernel, KERNEL_NAMES, static_cast<int>(Kernel::Count))) {
+        control->kernel.store(kernel);
+        change = std::string("Kernel: ") + KERNEL_NAMES[kernel];
+    }
+
+    int rng = control->rng.load();
+    if (ImGui::Combo("RNG", &rng, RNG_POLICY_NAMES, static_cast<int>(RngPolicy::Count))) {
+        control->rng.store(rng);
+        change = std::string("RNG: ") + RNG_POLICY_NAMES[rng];
+    }
+
+    // The new count is only applied once the slider is released.
+    if (!slider_threads)
+        slider_threads = control->requested_threads.load();
+    ImGui::SliderInt("Threads", &slider_threads, 1, MAX_THREADS);
+    if (ImGui::IsItemDeactivatedAfterEdit() && slider_threads != control->requested_threads.load()) {
+        control->requested_threads.store(slider_threads);
+        change = "Threads: " + std::to_string(slider_threads);
+    }
+
+    if (!change.empty()) {
+        ControlChange record = { change, now, average_ips(now - window, now), -1.0f };
+        control_changes.push_back(record);
+    }
+
+    for (ControlChange& record : control_changes) {
+        if (record.after < 0.0f && now >= record.at + settle + window)
+            record.after = average_ips(record.at + settle, record.at + settle + window);
+    }
+
+    if (ImGui::BeginTable("changes", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Change");
+        ImGui::TableSetupColumn("Before it/s");
+        ImGui::TableSetupColumn("After it/s");
+        ImGui::TableSetupColumn("Delta");
+        ImGui::TableHeadersRow();
+
+        for (auto it = control_changes.rbegin(); it != control_changes.rend(); ++it) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(it->label.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.0f", it->before);
+            ImGui::TableNextColumn();
+            if (it->after < 0.0f) {
+                ImGui::TextDisabled("measuring");
+                ImGui::TableNextColumn();
+                continue;
+            }
+            ImGui::Text("%.0f", it->after);
+            ImGui::TableNextColumn();
+            if (it->before > 0.0f)
+                ImGui::Text("%+.1f%%", (it->after / it->before - 1.0f) * 100.0f);
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+#endif
+
+void UI::draw()
+{
+    {
+        ScopedTimer draw_timer(profiler, FrameSection::Draw);
+
+        sync_stats();
+
+        SDL_RenderClear(m_window_renderer);
 
 #ifdef USE_IMGUI
+        ImGui_ImplSDLRenderer2_NewFrame();
+        ImGui_ImplSDL2_NewFrame();
+        ImGui::NewFrame();
+#endif
+
+        if (m_tiles.size() > 1) {
+            ScopedTimer timer(profiler, FrameSection::Bars);
+            render_grid();
+        }
+        else {
+            if (show_heatmap) {
+                ScopedTimer timer(profiler, FrameSection::Heatmap);
+                render_heatmap();
+            }
+
+            {
+                ScopedTimer timer(profiler, FrameSection::Bars);
+
+                SDL_Color color = success ? SDL_Color{ 0, 255, 0, 255 } : SDL_Color{ 255, 255, 255, 255 };
+                for (int i = 0; i < m_rects.size(); ++i)
+                {
+                    push_quad(m_rects[i], color);
+                }
+                flush_geometry();
+            }
+
+            {
+                ScopedTimer timer(profiler, FrameSection::Metadata);
+                render_metadata();
+            }
+        }
 
-    if (show_tool_metrics)
-        ImGui::ShowMetricsWindow(&show_tool_metrics);
-    if (show_tool_debug_log)
-        ImGui::ShowDebugLogWindow(&show_tool_debug_log);
+        SDL_SetRenderDrawColor(m_window_renderer, 0, 0, 0, 255);
 
-    ImGui::Render();
-    SDL_RenderSetScale(m_window_renderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
-    ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
+#ifdef USE_IMGUI
+        {
+            ScopedTimer timer(profiler, FrameSection::ImGui);
+
+            if (show_tool_metrics)
+                ImGui::ShowMetricsWindow(&show_tool_metrics);
+            if (show_tool_debug_log)
+                ImGui::ShowDebugLogWindow(&show_tool_debug_log);
+            stats->samples.read(dashboard_samples);
+            if (show_dashboard)
+                render_dashboard();
+            if (show_control_panel)
+                render_control_panel();
+            if (show_frame_cost)
+                render_frame_cost();
+            if (replay_enabled && stats->finished.load())
+                render_replay_panel();
+
+            ImGui::Render();
+            SDL_RenderSetScale(m_window_renderer, io.DisplayFramebufferScale.x, io.DisplayFramebufferScale.y);
+            ImGui_ImplSDLRenderer2_RenderDrawData(ImGui::GetDrawData());
+        }
 #endif
 
-    SDL_RenderPresent(m_window_renderer);
+        if (capture) {
+            ScopedTimer timer(profiler, FrameSection::Capture);
+            capture_frame();
+        }
+
+        {
+            ScopedTimer timer(profiler, FrameSection::Present);
+            SDL_RenderPresent(m_window_renderer);
+        }
+        for (Tile& tile : m_tiles) {
+            tile.stats->mark(tile.stats->first_frame_us);
+        }
+    }
+
+    profiler.end_frame();
+}
+
+void UI::start_capture(const std::string& path)
+{
+    int w = screen_w;
+    int h = screen_h;
+    SDL_GetRendererOutputSize(m_window_renderer, &w, &h);
 
+    capture.reset(new FrameCapture(path, w, h));
+    if (!capture->ok())
+        capture.reset();
+}
+
+// Reads the finished frame back into a pooled buffer for the encoder thread.
+// Nothing is read back when the pool is exhausted, so a slow disk costs
+// dropped frames rather than frame time.
+void UI::capture_frame()
+{
+    FrameCapture::Frame* frame = capture->acquire();
+    if (!frame)
+        return;
+
+    if (SDL_RenderReadPixels(m_window_renderer, NULL, SDL_PIXELFORMAT_RGB24, frame->rgb.data(), capture->width() * 3) < 0) {
+        std::cout << "Failed to read back frame" << std::endl;
+        std::cout << "SDL2 Error: " << SDL_GetError() << std::endl;
+        capture.reset();
+        return;
+    }
+
+    capture->submit(frame);
 }
 
 void UI::rect(int pos, int size, int total_bars)
@@ -271,7 +915,13 @@ void UI::render_number(const char* num)
 
 void UI::text(std::string text, SDL_Rect dest)
 {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), { 255, 255, 255, 255 });
+    ScopedTimer timer(profiler, FrameSection::Text);
+
+    TTF_Font* loaded = font.load();
+    if (!loaded)
+        return;
+
+    SDL_Surface* surface = TTF_RenderText_Solid(loaded, text.c_str(), { 255, 255, 255, 255 });
     SDL_Texture* texture = SDL_CreateTextureFromSurface(m_window_renderer, surface);
     SDL_RenderCopy(m_window_renderer, texture, NULL, &dest);
 
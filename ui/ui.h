@@ -6,8 +6,18 @@
 #include <map>
 #include <string>
 #include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <atomic>
+#include <thread>
 
 #include "../bogo.h"
+#include "../engine/kernels.h"
+#include "../engine/rng.h"
+#include "frame_capture.h"
+#include "frame_profiler.h"
 
 #ifdef USE_IMGUI
 #include "../imgui/imgui.h"
@@ -28,12 +38,27 @@ public:
     void rect(int pos, int size, int total_bars);
     void render_number(const char* num);
     void text(std::string text, SDL_Rect dest);
+    void start_capture(const std::string& path);
+
+    // Adds a search to the window. The first one added is the primary: it
+    // is the one shown alone, and the one the ImGui panels describe. With
+    // more than one the window switches to a grid of tiles.
+    void add_search(SearchStats* search_stats, const std::string& label);
+
+    // Lets R switch a finished primary search into replay, where the bars
+    // show the permutation any thread tried at any attempt, rebuilt with
+    // replay_attempt. Only meaningful if the search ran on the replayable
+    // kernel throughout.
+    void enable_replay(const std::string& input, uint64_t seed);
     bool success;
     bool running;
 
-    char* current_iteration;
-    int total_iterations;
+    // The primary search, copied from stats at the start of every frame.
+    std::string current_iteration;
+    uint64_t total_iterations;
     std::chrono::steady_clock::time_point start_time;
+    SearchStats* stats;
+    SearchControl* control = nullptr;
 #ifdef USE_IMGUI
     ImGuiIO io;
 #endif // USE_IMGUI
@@ -42,21 +67,78 @@ private:
     int screen_w;
     int screen_h;
 
+    void sync_stats();
+    void render_grid();
+    void push_quad(SDL_Rect rect, SDL_Color color);
+    void flush_geometry();
     void render_metadata();
+    void render_heatmap();
+    void capture_frame();
+    void toggle_replay();
+    void step_replay(int thread_step, int64_t attempt_step);
+#ifdef USE_IMGUI
+    void render_replay_panel();
+    void render_dashboard();
+    void render_control_panel();
+    void render_frame_cost();
+    float average_ips(float from, float to);
+#endif
 
     SDL_Window* m_window;
     SDL_Renderer* m_window_renderer;
     SDL_Event    m_window_event;
     std::map<int, SDL_Rect> m_rects;
 
+    struct Tile {
+        SearchStats* stats;
+        std::string label;
+        std::string current_iteration;
+        bool success;
+        float ips;
+    };
+    std::vector<Tile> m_tiles;
+
+    // Bars of every search are collected here and submitted with a single
+    // SDL_RenderGeometry call per frame.
+    std::vector<SDL_Vertex> m_vertices;
+    std::vector<int> m_indices;
+
     Uint32 startTicks;
     Uint64 startPerf;
     Uint64 totalFrameTicks;
     Uint64 totalFrames;
-    TTF_Font* font;
+    Uint64 lastFramePerf;
+    // Loaded on font_loader so the first frames don't wait for it; text()
+    // draws nothing until it is ready.
+    std::atomic<TTF_Font*> font;
+    std::thread font_loader;
+    bool show_heatmap = true;
+
+    bool replay_enabled = false;
+    bool replaying = false;
+    std::string replay_input;
+    uint64_t replay_seed = 0;
+    int replay_thread = 0;
+    uint64_t replay_attempt_number = 0;
+    std::unique_ptr<FrameCapture> capture;
+    FrameProfiler profiler;
 #ifdef USE_IMGUI
     bool show_tool_metrics = true;
     bool show_tool_debug_log = false;
+    bool show_dashboard = true;
+    bool show_control_panel = true;
+    bool show_frame_cost = false;
+    std::vector<Sample> dashboard_samples;
+
+    // A setting change and the throughput around it.
+    struct ControlChange {
+        std::string label;
+        float at;
+        float before;
+        float after;
+    };
+    std::vector<ControlChange> control_changes;
+    int slider_threads = 0;
 #endif // USE_IMGUI
 
 };
\ No newline at end of file